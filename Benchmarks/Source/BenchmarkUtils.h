@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    BenchmarkUtils.h
+    Created: 20 Oct 2026 11:05:52am
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+inline double millisecondsSince(juce::int64 startTicks)
+{
+    return 1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+}
+
+// Median, best and worst of a set of timings. The median is what gets
+// compared between runs; the worst case matters for the audio thread.
+struct TimingSummary
+{
+    double median = 0.0;
+    double best = 0.0;
+    double worst = 0.0;
+
+    explicit TimingSummary(std::vector<double> values)
+    {
+        if(values.empty()){ return; }
+        std::sort(values.begin(), values.end());
+        median = values[values.size() / 2];
+        best = values.front();
+        worst = values.back();
+    }
+};
+
+inline void printRow(const juce::String& name, const juce::String& value)
+{
+    std::cout << "  " << name.paddedRight(' ', 36) << value << std::endl;
+}
+
+inline void printTiming(const juce::String& name, const TimingSummary& timing, const char* unit)
+{
+    printRow(name, juce::String(timing.median, 3) + " " + unit + "  (best " + juce::String(timing.best, 3)
+                   + ", worst " + juce::String(timing.worst, 3) + ")");
+}
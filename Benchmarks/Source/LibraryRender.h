@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    LibraryRender.h
+    Created: 21 Oct 2026 10:03:51am
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "BenchmarkUtils.h"
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/MultisampleRenderer.h"
+
+// Samples every built-in preset into folder, as WAV files plus one SFZ file
+// per preset. numThreads = 0 uses one thread per core. Returns the time it
+// took in milliseconds, or a negative value if anything failed.
+inline double renderLibrary(const juce::File& folder, int numThreads)
+{
+    MultisampleSettings settings;
+    settings.numThreads = numThreads;
+
+    JX11AudioProcessor processor;
+    const std::vector<MultisamplePreset> presets = processor.getPresetSnapshots(float(settings.sampleRate));
+
+    const auto start = juce::Time::getHighResolutionTicks();
+    const bool ok = MultisampleRenderer::render(presets, settings, folder);
+    const double milliseconds = millisecondsSince(start);
+    return ok ? milliseconds : -1.0;
+}
+
+// True if both folders hold the same files with the same contents.
+inline bool sameFiles(const juce::File& first, const juce::File& second)
+{
+    const auto files = first.findChildFiles(juce::File::findFiles, false);
+    if(files.size() != second.findChildFiles(juce::File::findFiles, false).size()){ return false; }
+
+    for(const auto& file : files){
+        const juce::File other = second.getChildFile(file.getFileName());
+        if(!other.existsAsFile() || !file.hasIdenticalContentTo(other)){
+            return false;
+        }
+    }
+    return true;
+}
+
+// "render-library <folder> [threads]"
+inline int runRenderLibrary(const juce::File& folder, int numThreads)
+{
+    std::cout << "Rendering the preset library into " << folder.getFullPathName() << std::endl;
+
+    const double milliseconds = renderLibrary(folder, numThreads);
+    if(milliseconds < 0.0){
+        std::cout << "  failed" << std::endl;
+        return 1;
+    }
+    printRow("done", juce::String(milliseconds / 1000.0, 2) + " s");
+    return 0;
+}
+
+// Renders the library with one thread and with one per core, and checks the
+// files come out the same. The jobs share nothing, so they must.
+inline bool runLibraryCheck()
+{
+    std::cout << "Preset library, 1 thread against " << juce::SystemStats::getNumCpus() << std::endl;
+
+    const juce::File root = juce::File::getSpecialLocation(juce::File::tempDirectory).getNonexistentChildFile("JX11Library", "");
+    const juce::File single = root.getChildFile("1");
+    const juce::File multi = root.getChildFile("N");
+
+    const double singleTime = renderLibrary(single, 1);
+    const double multiTime = renderLibrary(multi, 0);
+    const bool ok = singleTime >= 0.0 && multiTime >= 0.0 && sameFiles(single, multi);
+    root.deleteRecursively();
+
+    if(singleTime >= 0.0 && multiTime >= 0.0){
+        printRow("1 thread", juce::String(singleTime / 1000.0, 2) + " s");
+        printRow("all cores", juce::String(multiTime / 1000.0, 2) + " s  ("
+                 + juce::String(singleTime / multiTime, 1) + "x)");
+    }
+    printRow("identical output", ok ? "yes" : "NO");
+    return ok;
+}
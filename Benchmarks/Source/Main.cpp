@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 20 Oct 2026 11:05:52am
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "StartupBenchmark.h"
+#include "RenderBenchmark.h"
+#include "ReleaseTailBenchmark.h"
+#include "LibraryRender.h"
+
+//==============================================================================
+// Runs the benchmarks named on the command line, or all of them. Build the
+// Release configuration; debug timings say little.
+//
+// "render-library <folder> [threads]" renders the preset library instead.
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray names;
+    for(int i = 1; i < argc; ++i){
+        names.add(argv[i]);
+    }
+
+    if(names[0] == "render-library"){
+        if(names.size() < 2){
+            std::cout << "usage: JX11Benchmarks render-library <folder> [threads]" << std::endl;
+            return 1;
+        }
+        const juce::File folder = juce::File::getCurrentWorkingDirectory().getChildFile(names[1]);
+        return runRenderLibrary(folder, names[2].getIntValue());
+    }
+    auto wanted = [&names](const char* name) { return names.isEmpty() || names.contains(name); };
+
+    if(wanted("startup")){
+        runStartupBenchmark();
+    }
+    if(wanted("render")){
+        runRenderBenchmark();
+    }
+    if(wanted("tails")){
+        runReleaseTailBenchmark();
+    }
+
+    // Not part of the default run, it writes a few hundred files.
+    if(names.contains("library")){
+        if(!runLibraryCheck()){ return 1; }
+    }
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    ReleaseTailBenchmark.h
+    Created: 20 Oct 2026 4:12:09pm
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "BenchmarkUtils.h"
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/OfflineRenderer.h"
+
+// Nanoseconds per output sample for each 5 s window after eight held notes
+// are released. The envelopes and the reverb decay towards zero the whole
+// time, which is where denormals would show up.
+inline std::vector<double> timeReleaseTail(const SynthParams& params, bool flushDenormals,
+                                           double sampleRate = 44100.0, int numWindows = 36)
+{
+    OfflineRenderer<float> renderer(params, sampleRate);
+    renderer.setFlushDenormals(flushDenormals);
+
+    juce::MidiBuffer notesOn;
+    juce::MidiBuffer notesOff;
+    for(int n = 0; n < 8; ++n){
+        notesOn.addEvent(juce::MidiMessage::noteOn(1, 48 + 3 * n, juce::uint8(100)), 0);
+        notesOff.addEvent(juce::MidiMessage::noteOff(1, 48 + 3 * n), 0);
+    }
+
+    juce::AudioBuffer<float> held(2, int(sampleRate));
+    renderer.render(notesOn, held);
+
+    juce::AudioBuffer<float> window(2, int(5.0 * sampleRate));
+    std::vector<double> timings;
+    for(int w = 0; w < numWindows; ++w){
+        const auto start = juce::Time::getHighResolutionTicks();
+        renderer.render((w == 0) ? notesOff : juce::MidiBuffer(), window);
+        timings.push_back(1.0e6 * millisecondsSince(start) / double(window.getNumSamples()));
+    }
+    return timings;
+}
+
+// The same tail with the engine's FTZ/DAZ and without it, where only the
+// explicit flushing in the voices and the reverb keeps the cost down. Uses
+// the init preset with a long release and the reverb on.
+inline void runReleaseTailBenchmark()
+{
+    std::cout << "Release tail, 8 voices held 1 s, then 3 min of release and reverb at 44.1 kHz" << std::endl;
+
+    JX11AudioProcessor processor;
+    SynthParams params = processor.getParamsSnapshot(44100.0f);
+    params.numVoices = 8;
+    params.envRelease = std::exp(-1.0f / (2.0f * 44100.0f));   // 2 s time constant
+    params.voiceFloor = 0.0f;                                  // fade all the way down
+    params.reverbMix = 0.3f;
+    params.reverbDecay = 4.0f;
+
+    for(bool flushDenormals : { true, false }){
+        const std::vector<double> windows = timeReleaseTail(params, flushDenormals);
+        const juce::String name = flushDenormals ? "FTZ/DAZ" : "no FTZ/DAZ";
+        printRow(name + ", first 5 s", juce::String(windows.front(), 1) + " ns/sample");
+        printTiming(name + ", 5 s windows after that",
+                    TimingSummary(std::vector<double>(windows.begin() + 1, windows.end())), "ns/sample");
+    }
+}
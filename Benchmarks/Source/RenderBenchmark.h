@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    RenderBenchmark.h
+    Created: 20 Oct 2026 11:48:20am
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "BenchmarkUtils.h"
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/OfflineRenderer.h"
+
+// Nanoseconds per output sample for numNotes held notes, median of a few
+// runs on a fresh engine each. With specialized off, the engine renders
+// through its generic loop instead of the compiled kernels.
+inline double timeHeldNotes(const SynthParams& params, int numChannels, int numNotes, double seconds,
+                            bool specialized = true, double sampleRate = 48000.0, int runs = 5)
+{
+    juce::MidiBuffer midi;
+    for(int n = 0; n < numNotes; ++n){
+        midi.addEvent(juce::MidiMessage::noteOn(1, 48 + 3 * n, juce::uint8(100)), 0);
+    }
+
+    const int numSamples = int(seconds * sampleRate);
+    juce::AudioBuffer<float> buffer(numChannels, numSamples);
+
+    std::vector<double> timings;
+    for(int run = 0; run < runs; ++run){
+        OfflineRenderer<float> renderer(params, sampleRate);
+        renderer.setSpecializeRender(specialized);
+        const auto start = juce::Time::getHighResolutionTicks();
+        renderer.render(midi, buffer);
+        timings.push_back(1.0e6 * millisecondsSince(start) / double(numSamples));
+    }
+    return TimingSummary(timings).median;
+}
+
+// One row per render kernel: every combination of the flags Synth picks a
+// compiled kernel for once per block (output channels, noise source), for
+// one voice and for eight. Each is compared with the generic loop that
+// tests those flags as it renders. Uses the init preset.
+inline void runRenderBenchmark()
+{
+    std::cout << "Render kernels against the generic loop, init preset, 10 s of held notes at 48 kHz" << std::endl;
+
+    JX11AudioProcessor processor;
+    const SynthParams preset = processor.getParamsSnapshot(48000.0f);
+
+    struct NoiseSetting { const char* name; float mix; bool perVoice; };
+    const NoiseSetting noiseSettings[] = { { "no noise", 0.0f, false },
+                                           { "shared noise", 0.01f, false },
+                                           { "per-voice noise", 0.01f, true } };
+
+    for(int numVoices : { 1, 8 }){
+        for(int numChannels : { 1, 2 }){
+            for(const auto& noise : noiseSettings){
+                SynthParams params = preset;
+                params.numVoices = numVoices;
+                params.noiseMix = noise.mix;
+                params.perVoiceNoise = noise.perVoice;
+
+                const double nanoseconds = timeHeldNotes(params, numChannels, numVoices, 10.0);
+                const double baseline = timeHeldNotes(params, numChannels, numVoices, 10.0, false);
+                printRow(juce::String(numVoices) + (numVoices == 1 ? " voice, " : " voices, ")
+                         + (numChannels == 1 ? "mono, " : "stereo, ") + noise.name,
+                         juce::String(nanoseconds, 1) + " ns/sample  ("
+                         + juce::String(nanoseconds / numVoices, 1) + " per voice), generic loop "
+                         + juce::String(baseline, 1) + " ns/sample, "
+                         + juce::String(baseline / nanoseconds, 2) + "x");
+            }
+        }
+    }
+}
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    StartupBenchmark.h
+    Created: 20 Oct 2026 11:05:52am
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "BenchmarkUtils.h"
+#include "../../Source/PluginProcessor.h"
+
+// What a host scan or a session with many instances pays per plug-in:
+// constructing the processor, prepareToPlay, and the first block after it.
+// The first instance also builds the shared tables and presets, so it is
+// reported on its own.
+inline void runStartupBenchmark(int numInstances = 50)
+{
+    std::cout << "Startup, " << numInstances << " instances at 48 kHz / 512" << std::endl;
+
+    std::vector<double> construction, prepare, firstBlock;
+    juce::AudioBuffer<float> buffer(2, 512);
+    juce::MidiBuffer midi;
+
+    for(int i = 0; i < numInstances; ++i){
+        auto start = juce::Time::getHighResolutionTicks();
+        auto processor = std::make_unique<JX11AudioProcessor>();
+        construction.push_back(millisecondsSince(start));
+
+        start = juce::Time::getHighResolutionTicks();
+        processor->setPlayConfigDetails(0, 2, 48000.0, 512);
+        processor->prepareToPlay(48000.0, 512);
+        prepare.push_back(millisecondsSince(start));
+
+        buffer.clear();
+        start = juce::Time::getHighResolutionTicks();
+        processor->processBlock(buffer, midi);
+        firstBlock.push_back(millisecondsSince(start));
+    }
+
+    printRow("first construction", juce::String(construction.front(), 3) + " ms");
+    construction.erase(construction.begin());
+    printTiming("construction", TimingSummary(construction), "ms");
+    printTiming("prepareToPlay", TimingSummary(prepare), "ms");
+    printTiming("first processBlock", TimingSummary(firstBlock), "ms");
+}
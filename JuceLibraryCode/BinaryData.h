@@ -8,29 +8,17 @@
 
 namespace BinaryData
 {
-    extern const char*   CloseupFrontviewWhitefacadeofdirtyindustrialmetalTheentirecenteriswhite_jpg;
-    const int            CloseupFrontviewWhitefacadeofdirtyindustrialmetalTheentirecenteriswhite_jpgSize = 822806;
+    extern const char*   background_1x_jpg;
+    const int            background_1x_jpgSize = 41679;
 
-    extern const char*   Whitefacadeofmetalwithcornersofcopper_2_jpg;
-    const int            Whitefacadeofmetalwithcornersofcopper_2_jpgSize = 237794;
-
-    extern const char*   Whitefacadeofmetalwithcornersofcopper_jpg;
-    const int            Whitefacadeofmetalwithcornersofcopper_jpgSize = 463578;
-
-    extern const char*   pngtreetexturedwhitebackgroundasubtleandelegantcanvasimage_13867293_png;
-    const int            pngtreetexturedwhitebackgroundasubtleandelegantcanvasimage_13867293_pngSize = 658113;
-
-    extern const char*   craiyon_212111_abstract_textured_dark_red_velvet_png;
-    const int            craiyon_212111_abstract_textured_dark_red_velvet_pngSize = 1201947;
-
-    extern const char*   whiteSquare_jpeg;
-    const int            whiteSquare_jpegSize = 399187;
+    extern const char*   background_2x_jpg;
+    const int            background_2x_jpgSize = 147871;
 
     extern const char*   LatoMedium_ttf;
     const int            LatoMedium_ttfSize = 663564;
 
     // Number of elements in the namedResourceList and originalFileNames arrays.
-    const int namedResourceListSize = 7;
+    const int namedResourceListSize = 3;
 
     // Points to the start of a list of resource names.
     extern const char* namedResourceList[];
@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+"""
+Pre-scales the images the editor actually uses into Assets/.
+
+Only the files listed in ASSETS are embedded (see the Resources group in
+JX11.jucer). Each one is resized once, here, to the exact sizes the editor
+draws at, so the plug-in never decodes a full-size photo just to shrink it.
+Re-run this after changing a source picture or the editor size, then save the
+project in the Projucer to regenerate BinaryData.
+
+Requires Pillow (pip install pillow).
+"""
+
+import os
+import sys
+
+from PIL import Image
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# Editor size in points. Keep in sync with JX11AudioProcessorEditor.
+EDITOR_WIDTH = 806
+EDITOR_HEIGHT = 460
+
+# (source picture, output name, display scale factors)
+ASSETS = [
+    ("Pictures/Close-up--Front-view--White-facade-of-dirty-industrial-metal--The-entire-center-is-white-.jpg",
+     "background", [1, 2]),
+]
+
+JPEG_QUALITY = 88
+
+
+def build(source, name, scales):
+    image = Image.open(os.path.join(ROOT, source)).convert("RGB")
+    for scale in scales:
+        size = (EDITOR_WIDTH * scale, EDITOR_HEIGHT * scale)
+        output = os.path.join(ROOT, "Assets", "%s_%dx.jpg" % (name, scale))
+        image.resize(size, Image.LANCZOS).save(output, "JPEG", quality=JPEG_QUALITY, optimize=True)
+        print("%s -> %s %dx%d (%d bytes)" % (source, output, size[0], size[1], os.path.getsize(output)))
+
+
+def main():
+    os.makedirs(os.path.join(ROOT, "Assets"), exist_ok=True)
+    for source, name, scales in ASSETS:
+        build(source, name, scales)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
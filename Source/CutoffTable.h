@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    CutoffTable.h
+    Created: 19 Oct 2026 7:48:15pm
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Filter coefficients as a function of the cutoff, so a coefficient update
+// is an interpolated table read instead of an exp() or tan() call. The
+// tables are indexed by the natural log of the cutoff in Hz, the domain the
+// voices already work in: key tracking, envelope, LFO and bend all add up
+// there. Cutoffs outside 30 Hz - 20 kHz are clamped.
+//
+// The coefficients depend on the sample rate, so every engine builds its own
+// tables in allocateResources().
+template <typename SampleType>
+class CutoffTable
+{
+public:
+    static constexpr double MIN_CUTOFF = 30.0;
+    static constexpr double MAX_CUTOFF = 20000.0;
+
+    // About 0.006 in log-cutoff, or a tenth of a semitone, between points.
+    static constexpr size_t NUM_POINTS = 1024;
+
+    void prepare(double sampleRate)
+    {
+        const SampleType minimum = SampleType(std::log(MIN_CUTOFF));
+        const SampleType maximum = SampleType(std::log(MAX_CUTOFF));
+
+        // The one-pole coefficient of FilterLadder.
+        ladder.initialise([sampleRate] (SampleType x) {
+            return SampleType(std::exp(-juce::MathConstants<double>::twoPi * std::exp(double(x)) / sampleRate));
+        }, minimum, maximum, NUM_POINTS);
+
+        // g of the state-variable Filter. Kept below Nyquist at low sample
+        // rates, where tan() would blow up.
+        svf.initialise([sampleRate] (SampleType x) {
+            const double cutoff = std::min(std::exp(double(x)), 0.49 * sampleRate);
+            return SampleType(std::tan(juce::MathConstants<double>::pi * cutoff / sampleRate));
+        }, minimum, maximum, NUM_POINTS);
+    }
+
+    SampleType getLadderCoefficient(SampleType logCutoff) const
+    {
+        return ladder.processSample(logCutoff);
+    }
+
+    SampleType getSvfCoefficient(SampleType logCutoff) const
+    {
+        return svf.processSample(logCutoff);
+    }
+
+private:
+    juce::dsp::LookupTableTransform<SampleType> ladder;
+    juce::dsp::LookupTableTransform<SampleType> svf;
+};
@@ -0,0 +1,441 @@
+/*
+  ==============================================================================
+
+    DspKernels.cpp
+    Created: 19 Oct 2026 3:12:44pm
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#include "DspKernels.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+ #define JX11_CPU_DISPATCH 1
+#else
+ #define JX11_CPU_DISPATCH 0
+#endif
+
+// The reverb matrix and the envelope lanes are written with the GCC/clang
+// vector extensions; other compilers get the plain loops.
+#if defined(__has_builtin)
+ #if __has_builtin(__builtin_shufflevector)
+  #define JX11_VECTOR_LANES 1
+ #endif
+#endif
+#ifndef JX11_VECTOR_LANES
+ #define JX11_VECTOR_LANES 0
+#endif
+
+#if JX11_CPU_DISPATCH
+ // GCC 12's intrinsic headers trip -Wmaybe-uninitialized on their own
+ // placeholder vectors.
+ #pragma GCC diagnostic push
+ #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+ #include <immintrin.h>
+ #pragma GCC diagnostic pop
+#endif
+
+// AVX-512 brings FMA instructions. Don't let the compiler fuse multiplies
+// and adds, or the variants would round differently.
+// GCC only vectorizes loops with a remainder from -O3 on, and the kernels
+// are pointless without it, so ask for it here whatever the build uses.
+#if defined(__clang__)
+ #pragma clang fp contract(off)
+#elif defined(__GNUC__)
+ #pragma GCC optimize("fp-contract=off", "tree-vectorize")
+#endif
+
+namespace
+{
+    template <typename SampleType>
+    forcedinline void fillNoiseBody(NoiseGenerator& generator, SampleType* dest, SampleType gain, int sampleCount)
+    {
+        generator.fill(dest, sampleCount);
+        for(int i = 0; i < sampleCount; ++i){
+            dest[i] *= gain;
+        }
+    }
+
+    template <typename SampleType>
+    forcedinline void writeStereoBody(const SampleType* __restrict mixLeft, const SampleType* __restrict mixRight,
+                                      SampleType* __restrict left, SampleType* __restrict right, SampleType gain, int sampleCount)
+    {
+        for(int i = 0; i < sampleCount; ++i){
+            left[i] = mixLeft[i] * gain;
+            right[i] = mixRight[i] * gain;
+        }
+    }
+
+    template <typename SampleType>
+    forcedinline void writeMonoBody(const SampleType* __restrict mixLeft, const SampleType* __restrict mixRight,
+                                    SampleType* __restrict output, SampleType gain, int sampleCount)
+    {
+        for(int i = 0; i < sampleCount; ++i){
+            output[i] = (mixLeft[i] * gain + mixRight[i] * gain) * SampleType(0.5);
+        }
+    }
+
+    template <typename SampleType>
+    forcedinline void readDelayBody(const SampleType* line, const SampleType* positions, SampleType* dest, int sampleCount)
+    {
+        for(int i = 0; i < sampleCount; ++i){
+            const int index = int(positions[i]);
+            const SampleType fraction = positions[i] - SampleType(index);
+            const SampleType a = line[index];
+            dest[i] = a + fraction * (line[index + 1] - a);
+        }
+    }
+
+    template <typename SampleType>
+    forcedinline void feedbackMatrixBody(SampleType* __restrict frames, SampleType* __restrict lowpass,
+                                         const SampleType* __restrict gains, const SampleType* __restrict inputGains,
+                                         SampleType damping, const SampleType* __restrict input,
+                                         SampleType* __restrict wetLeft, SampleType* __restrict wetRight, int sampleCount)
+    {
+        const SampleType scale = SampleType(0.3535533906);   // 1 / sqrt(8)
+
+       #if JX11_VECTOR_LANES
+        // A frame is one vector of eight floats, or a low and a high vector
+        // of four doubles: GCC moves vectors wider than 32 bytes through the
+        // stack. Each butterfly stage of the Walsh-Hadamard transform is a
+        // lane swap plus a sign flip, or the sum and difference of the two
+        // halves, so everything rounds exactly as in the scalar version.
+        static_assert(FDN_LINES == 8, "the butterflies are written for eight lines");
+
+        if constexpr(sizeof(SampleType) == sizeof(float)){
+            typedef SampleType Lanes __attribute__((vector_size(8 * sizeof(SampleType))));
+            const Lanes sign1 = { 1, -1, 1, -1, 1, -1, 1, -1 };
+            const Lanes sign2 = { 1, 1, -1, -1, 1, 1, -1, -1 };
+            const Lanes sign4 = { 1, 1, 1, 1, -1, -1, -1, -1 };
+
+            Lanes state, gain, inputGain;
+            __builtin_memcpy(&state, lowpass, sizeof(Lanes));
+            __builtin_memcpy(&gain, gains, sizeof(Lanes));
+            __builtin_memcpy(&inputGain, inputGains, sizeof(Lanes));
+
+            for(int i = 0; i < sampleCount; ++i){
+                SampleType* x = frames + i * FDN_LINES;
+                wetLeft[i] = SampleType(0) + x[0] + x[2] + x[4] + x[6];
+                wetRight[i] = SampleType(0) + x[1] + x[3] + x[5] + x[7];
+
+                Lanes frame;
+                __builtin_memcpy(&frame, x, sizeof(Lanes));
+                state += damping * (frame - state);
+
+                Lanes y = state * gain;
+                y = __builtin_shufflevector(y, y, 1, 0, 3, 2, 5, 4, 7, 6) + y * sign1;
+                y = __builtin_shufflevector(y, y, 2, 3, 0, 1, 6, 7, 4, 5) + y * sign2;
+                y = __builtin_shufflevector(y, y, 4, 5, 6, 7, 0, 1, 2, 3) + y * sign4;
+
+                frame = y * scale + input[i] * inputGain;
+                __builtin_memcpy(x, &frame, sizeof(Lanes));
+            }
+            __builtin_memcpy(lowpass, &state, sizeof(Lanes));
+        }else{
+            typedef SampleType Lanes __attribute__((vector_size(4 * sizeof(SampleType))));
+            const Lanes sign1 = { 1, -1, 1, -1 };
+            const Lanes sign2 = { 1, 1, -1, -1 };
+
+            Lanes stateLow, stateHigh, gainLow, gainHigh, inputGainLow, inputGainHigh;
+            __builtin_memcpy(&stateLow, lowpass, sizeof(Lanes));
+            __builtin_memcpy(&stateHigh, lowpass + 4, sizeof(Lanes));
+            __builtin_memcpy(&gainLow, gains, sizeof(Lanes));
+            __builtin_memcpy(&gainHigh, gains + 4, sizeof(Lanes));
+            __builtin_memcpy(&inputGainLow, inputGains, sizeof(Lanes));
+            __builtin_memcpy(&inputGainHigh, inputGains + 4, sizeof(Lanes));
+
+            for(int i = 0; i < sampleCount; ++i){
+                SampleType* x = frames + i * FDN_LINES;
+                wetLeft[i] = SampleType(0) + x[0] + x[2] + x[4] + x[6];
+                wetRight[i] = SampleType(0) + x[1] + x[3] + x[5] + x[7];
+
+                Lanes low, high;
+                __builtin_memcpy(&low, x, sizeof(Lanes));
+                __builtin_memcpy(&high, x + 4, sizeof(Lanes));
+                stateLow += damping * (low - stateLow);
+                stateHigh += damping * (high - stateHigh);
+
+                Lanes a = stateLow * gainLow;
+                Lanes b = stateHigh * gainHigh;
+                a = __builtin_shufflevector(a, a, 1, 0, 3, 2) + a * sign1;
+                b = __builtin_shufflevector(b, b, 1, 0, 3, 2) + b * sign1;
+                a = __builtin_shufflevector(a, a, 2, 3, 0, 1) + a * sign2;
+                b = __builtin_shufflevector(b, b, 2, 3, 0, 1) + b * sign2;
+
+                low = (a + b) * scale + input[i] * inputGainLow;
+                high = (a - b) * scale + input[i] * inputGainHigh;
+                __builtin_memcpy(x, &low, sizeof(Lanes));
+                __builtin_memcpy(x + 4, &high, sizeof(Lanes));
+            }
+            __builtin_memcpy(lowpass, &stateLow, sizeof(Lanes));
+            __builtin_memcpy(lowpass + 4, &stateHigh, sizeof(Lanes));
+        }
+       #else
+        for(int i = 0; i < sampleCount; ++i){
+            SampleType* x = frames + i * FDN_LINES;
+
+            SampleType left = 0;
+            SampleType right = 0;
+            for(int l = 0; l < FDN_LINES; l += 2){
+                left += x[l];
+                right += x[l + 1];
+            }
+            wetLeft[i] = left;
+            wetRight[i] = right;
+
+            SampleType y[FDN_LINES];
+            for(int l = 0; l < FDN_LINES; ++l){
+                lowpass[l] += damping * (x[l] - lowpass[l]);
+                y[l] = lowpass[l] * gains[l];
+            }
+
+            // Fast Walsh-Hadamard transform, orthogonal with the final scale.
+            for(int half = 1; half < FDN_LINES; half *= 2){
+                for(int l = 0; l < FDN_LINES; l += 2 * half){
+                    for(int j = l; j < l + half; ++j){
+                        const SampleType a = y[j];
+                        const SampleType b = y[j + half];
+                        y[j] = a + b;
+                        y[j + half] = a - b;
+                    }
+                }
+            }
+
+            for(int l = 0; l < FDN_LINES; ++l){
+                x[l] = y[l] * scale + input[i] * inputGains[l];
+            }
+        }
+       #endif
+    }
+
+    // The lanes are independent, so they are stepped in groups as wide as
+    // the target's vector registers: a group that doesn't fit in registers
+    // goes through the stack on every sample. The switch to the decay stage
+    // is a bitwise select on the comparison mask, because GCC lowers the
+    // ?: of two vectors to one branch per lane when there's no blend
+    // instruction. The arithmetic is that of Envelope::nextValue().
+    template <int VECTOR_BYTES, typename SampleType>
+    forcedinline void envelopeLanesBody(SampleType* __restrict levels, SampleType* __restrict multipliers, SampleType* __restrict targets,
+                                        const SampleType* __restrict decayMultipliers, const SampleType* __restrict sustainLevels,
+                                        SampleType* __restrict frames, int sampleCount)
+    {
+       #if JX11_VECTOR_LANES
+        constexpr int width = VECTOR_BYTES / int(sizeof(SampleType));
+        static_assert(ENVELOPE_LANES % width == 0, "the lanes must split into whole vectors");
+        typedef SampleType Lanes __attribute__((vector_size(VECTOR_BYTES)));
+        typedef std::conditional_t<sizeof(SampleType) == sizeof(float), juce::int32, juce::int64> Bits;
+        typedef Bits Mask __attribute__((vector_size(VECTOR_BYTES)));
+        
+        for(int group = 0; group < ENVELOPE_LANES; group += width){
+            Lanes level, multiplier, target, decayMultiplier, sustainLevel;
+            __builtin_memcpy(&level, levels + group, sizeof(Lanes));
+            __builtin_memcpy(&multiplier, multipliers + group, sizeof(Lanes));
+            __builtin_memcpy(&target, targets + group, sizeof(Lanes));
+            __builtin_memcpy(&decayMultiplier, decayMultipliers + group, sizeof(Lanes));
+            __builtin_memcpy(&sustainLevel, sustainLevels + group, sizeof(Lanes));
+            const Lanes three = SampleType(3) - Lanes{};
+            
+            for(int n = 0; n < sampleCount; ++n){
+                level = multiplier * (level - target) + target;
+                const Mask toDecay = level + target > three;
+                multiplier = (Lanes)((toDecay & (Mask)decayMultiplier) | (~toDecay & (Mask)multiplier));
+                target = (Lanes)((toDecay & (Mask)sustainLevel) | (~toDecay & (Mask)target));
+                __builtin_memcpy(frames + n * ENVELOPE_LANES + group, &level, sizeof(Lanes));
+            }
+            
+            __builtin_memcpy(levels + group, &level, sizeof(Lanes));
+            __builtin_memcpy(multipliers + group, &multiplier, sizeof(Lanes));
+            __builtin_memcpy(targets + group, &target, sizeof(Lanes));
+        }
+       #else
+        for(int n = 0; n < sampleCount; ++n){
+            SampleType* frame = frames + n * ENVELOPE_LANES;
+            for(int lane = 0; lane < ENVELOPE_LANES; ++lane){
+                levels[lane] = multipliers[lane] * (levels[lane] - targets[lane]) + targets[lane];
+                if(levels[lane] + targets[lane] > SampleType(3)){
+                    multipliers[lane] = decayMultipliers[lane];
+                    targets[lane] = sustainLevels[lane];
+                }
+                frame[lane] = levels[lane];
+            }
+        }
+       #endif
+    }
+
+    // One set of wrappers per instruction set. The bodies are inlined into
+    // them, so each wrapper is compiled with its own target's instructions.
+    #define JX11_KERNEL_VARIANT(name, attributes, vectorBytes) \
+        template <typename SampleType> attributes \
+        void fillNoise_##name(NoiseGenerator& generator, SampleType* dest, SampleType gain, int sampleCount) \
+        { fillNoiseBody(generator, dest, gain, sampleCount); } \
+        template <typename SampleType> attributes \
+        void writeStereo_##name(const SampleType* mixLeft, const SampleType* mixRight, SampleType* left, SampleType* right, SampleType gain, int sampleCount) \
+        { writeStereoBody(mixLeft, mixRight, left, right, gain, sampleCount); } \
+        template <typename SampleType> attributes \
+        void writeMono_##name(const SampleType* mixLeft, const SampleType* mixRight, SampleType* output, SampleType gain, int sampleCount) \
+        { writeMonoBody(mixLeft, mixRight, output, gain, sampleCount); } \
+        template <typename SampleType> attributes \
+        void feedbackMatrix_##name(SampleType* frames, SampleType* lowpass, const SampleType* gains, const SampleType* inputGains, \
+                                   SampleType damping, const SampleType* input, SampleType* wetLeft, SampleType* wetRight, int sampleCount) \
+        { feedbackMatrixBody(frames, lowpass, gains, inputGains, damping, input, wetLeft, wetRight, sampleCount); } \
+        template <typename SampleType> attributes \
+        void envelopeLanes_##name(SampleType* levels, SampleType* multipliers, SampleType* targets, const SampleType* decayMultipliers, \
+                                  const SampleType* sustainLevels, SampleType* frames, int sampleCount) \
+        { envelopeLanesBody<vectorBytes>(levels, multipliers, targets, decayMultipliers, sustainLevels, frames, sampleCount); }
+
+    JX11_KERNEL_VARIANT(generic, , 16)
+   #if JX11_CPU_DISPATCH
+    JX11_KERNEL_VARIANT(sse42, __attribute__((target("sse4.2"))), 16)
+    JX11_KERNEL_VARIANT(avx2, __attribute__((target("avx2"))), 32)
+    JX11_KERNEL_VARIANT(avx512, __attribute__((target("avx512f,avx512vl,avx512bw,avx512dq"))), 32)
+   #endif
+
+    #undef JX11_KERNEL_VARIANT
+
+    // The delay reads are a gather, which the compiler won't generate on
+    // its own. Without gather instructions they stay scalar.
+    template <typename SampleType>
+    void readDelay_generic(const SampleType* line, const SampleType* positions, SampleType* dest, int sampleCount)
+    {
+        readDelayBody(line, positions, dest, sampleCount);
+    }
+
+   #if JX11_CPU_DISPATCH
+    template <typename SampleType> __attribute__((target("sse4.2")))
+    void readDelay_sse42(const SampleType* line, const SampleType* positions, SampleType* dest, int sampleCount)
+    {
+        readDelayBody(line, positions, dest, sampleCount);
+    }
+
+    // Positions are never negative, so truncating them in the vector unit
+    // gives the same indices as int(). Both neighbours are gathered and
+    // interpolated with the same separate multiply and add as the scalar
+    // loop, which handles the remainder.
+    template <typename SampleType> __attribute__((target("avx2")))
+    void readDelay_avx2(const SampleType* line, const SampleType* positions, SampleType* dest, int sampleCount)
+    {
+        int i = 0;
+        if constexpr(std::is_same_v<SampleType, float>){
+            for(; i + 8 <= sampleCount; i += 8){
+                const __m256 position = _mm256_loadu_ps(positions + i);
+                const __m256i index = _mm256_cvttps_epi32(position);
+                const __m256 fraction = _mm256_sub_ps(position, _mm256_cvtepi32_ps(index));
+                const __m256 a = _mm256_i32gather_ps(line, index, 4);
+                const __m256 b = _mm256_i32gather_ps(line + 1, index, 4);
+                _mm256_storeu_ps(dest + i, _mm256_add_ps(a, _mm256_mul_ps(fraction, _mm256_sub_ps(b, a))));
+            }
+        }else{
+            for(; i + 4 <= sampleCount; i += 4){
+                const __m256d position = _mm256_loadu_pd(positions + i);
+                const __m128i index = _mm256_cvttpd_epi32(position);
+                const __m256d fraction = _mm256_sub_pd(position, _mm256_cvtepi32_pd(index));
+                const __m256d a = _mm256_i32gather_pd(line, index, 8);
+                const __m256d b = _mm256_i32gather_pd(line + 1, index, 8);
+                _mm256_storeu_pd(dest + i, _mm256_add_pd(a, _mm256_mul_pd(fraction, _mm256_sub_pd(b, a))));
+            }
+        }
+        readDelayBody(line, positions + i, dest + i, sampleCount - i);
+    }
+
+    template <typename SampleType> __attribute__((target("avx512f,avx512vl,avx512bw,avx512dq")))
+    void readDelay_avx512(const SampleType* line, const SampleType* positions, SampleType* dest, int sampleCount)
+    {
+        int i = 0;
+        if constexpr(std::is_same_v<SampleType, float>){
+            for(; i + 16 <= sampleCount; i += 16){
+                const __m512 position = _mm512_loadu_ps(positions + i);
+                const __m512i index = _mm512_cvttps_epi32(position);
+                const __m512 fraction = _mm512_sub_ps(position, _mm512_cvtepi32_ps(index));
+                const __m512 a = _mm512_i32gather_ps(index, line, 4);
+                const __m512 b = _mm512_i32gather_ps(index, line + 1, 4);
+                _mm512_storeu_ps(dest + i, _mm512_add_ps(a, _mm512_mul_ps(fraction, _mm512_sub_ps(b, a))));
+            }
+        }else{
+            for(; i + 8 <= sampleCount; i += 8){
+                const __m512d position = _mm512_loadu_pd(positions + i);
+                const __m256i index = _mm512_cvttpd_epi32(position);
+                const __m512d fraction = _mm512_sub_pd(position, _mm512_cvtepi32_pd(index));
+                const __m512d a = _mm512_i32gather_pd(index, line, 8);
+                const __m512d b = _mm512_i32gather_pd(index, line + 1, 8);
+                _mm512_storeu_pd(dest + i, _mm512_add_pd(a, _mm512_mul_pd(fraction, _mm512_sub_pd(b, a))));
+            }
+        }
+        readDelayBody(line, positions + i, dest + i, sampleCount - i);
+    }
+   #endif
+}
+
+template <typename SampleType>
+const DspKernels<SampleType>& DspKernels<SampleType>::get(CpuVariant variant)
+{
+    static const DspKernels generic { fillNoise_generic<SampleType>, writeStereo_generic<SampleType>, writeMono_generic<SampleType>,
+                                      readDelay_generic<SampleType>, feedbackMatrix_generic<SampleType>,
+                                      envelopeLanes_generic<SampleType> };
+
+   #if JX11_CPU_DISPATCH
+    static const DspKernels sse42 { fillNoise_sse42<SampleType>, writeStereo_sse42<SampleType>, writeMono_sse42<SampleType>,
+                                    readDelay_sse42<SampleType>, feedbackMatrix_sse42<SampleType>,
+                                    envelopeLanes_sse42<SampleType> };
+    static const DspKernels avx2 { fillNoise_avx2<SampleType>, writeStereo_avx2<SampleType>, writeMono_avx2<SampleType>,
+                                   readDelay_avx2<SampleType>, feedbackMatrix_avx2<SampleType>,
+                                   envelopeLanes_avx2<SampleType> };
+    static const DspKernels avx512 { fillNoise_avx512<SampleType>, writeStereo_avx512<SampleType>, writeMono_avx512<SampleType>,
+                                     readDelay_avx512<SampleType>, feedbackMatrix_avx512<SampleType>,
+                                     envelopeLanes_avx512<SampleType> };
+
+    // Never run a variant the CPU can't execute.
+    if(int(variant) > int(detectCpuVariant())){
+        variant = detectCpuVariant();
+    }
+
+    switch(variant){
+        case CpuVariant::avx512: return avx512;
+        case CpuVariant::avx2:   return avx2;
+        case CpuVariant::sse42:  return sse42;
+        default: break;
+    }
+   #else
+    juce::ignoreUnused(variant);
+   #endif
+
+    return generic;
+}
+
+template struct DspKernels<float>;
+template struct DspKernels<double>;
+
+CpuVariant detectCpuVariant()
+{
+   #if JX11_CPU_DISPATCH
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl")
+       && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq")){
+        return CpuVariant::avx512;
+    }
+    if(__builtin_cpu_supports("avx2")){ return CpuVariant::avx2; }
+    if(__builtin_cpu_supports("sse4.2")){ return CpuVariant::sse42; }
+   #endif
+    return CpuVariant::generic;
+}
+
+CpuVariant chooseCpuVariant()
+{
+    const char* forced = std::getenv("JX11_CPU_VARIANT");
+    if(forced != nullptr){
+        for(auto variant : { CpuVariant::generic, CpuVariant::sse42, CpuVariant::avx2, CpuVariant::avx512 }){
+            if(std::strcmp(forced, getCpuVariantName(variant)) == 0){ return variant; }
+        }
+    }
+    return detectCpuVariant();
+}
+
+const char* getCpuVariantName(CpuVariant variant)
+{
+    switch(variant){
+        case CpuVariant::sse42:  return "sse42";
+        case CpuVariant::avx2:   return "avx2";
+        case CpuVariant::avx512: return "avx512";
+        default:                 return "generic";
+    }
+}
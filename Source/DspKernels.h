@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    DspKernels.h
+    Created: 19 Oct 2026 3:12:44pm
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "NoiseGenerator.h"
+
+// Instruction sets the vectorizable kernels are compiled for. One binary
+// carries all of them and picks one at prepareToPlay.
+enum class CpuVariant { generic, sse42, avx2, avx512 };
+
+// Delay lines in the reverb's feedback network, one per SIMD lane.
+constexpr int FDN_LINES = 8;
+
+// Voice envelopes rendered together, one per SIMD lane.
+constexpr int ENVELOPE_LANES = 8;
+
+// The inner loops that vectorize across samples, or across voices. The
+// per-voice oscillator and filter recurrences are serial, so they stay in
+// Voice. Every variant produces bit-identical output.
+template <typename SampleType>
+struct DspKernels
+{
+    void (*fillNoise)(NoiseGenerator& generator, SampleType* dest, SampleType gain, int sampleCount);
+    void (*writeStereo)(const SampleType* mixLeft, const SampleType* mixRight, SampleType* left, SampleType* right, SampleType gain, int sampleCount);
+    void (*writeMono)(const SampleType* mixLeft, const SampleType* mixRight, SampleType* output, SampleType gain, int sampleCount);
+
+    // Linear interpolation at fractional positions in a delay line. line[]
+    // must hold one sample past the largest position.
+    void (*readDelay)(const SampleType* line, const SampleType* positions, SampleType* dest, int sampleCount);
+
+    // One block of the reverb's feedback network. frames holds the delay
+    // line outputs, FDN_LINES per sample, and is overwritten with what goes
+    // back into the lines: damped, scaled by gains, mixed through a
+    // Hadamard matrix and fed with input times inputGains. The outputs are
+    // also summed into wetLeft (even lines) and wetRight (odd lines).
+    void (*feedbackMatrix)(SampleType* frames, SampleType* lowpass, const SampleType* gains, const SampleType* inputGains,
+                           SampleType damping, const SampleType* input, SampleType* wetLeft, SampleType* wetRight, int sampleCount);
+
+    // One run of ENVELOPE_LANES envelopes side by side, each stepped as in
+    // Envelope::nextValue(), into frames[n * ENVELOPE_LANES + lane]. levels,
+    // multipliers and targets hold the state and are updated.
+    void (*envelopeLanes)(SampleType* levels, SampleType* multipliers, SampleType* targets, const SampleType* decayMultipliers,
+                          const SampleType* sustainLevels, SampleType* frames, int sampleCount);
+
+    // Kernels for the given variant. Falls back to the best one the CPU has
+    // if the variant isn't supported or wasn't compiled for this platform.
+    static const DspKernels& get(CpuVariant variant);
+};
+
+// Best variant the CPU supports.
+CpuVariant detectCpuVariant();
+
+// The detected variant, unless the JX11_CPU_VARIANT environment variable
+// names another one (generic, sse42, avx2 or avx512) for testing and
+// benchmarking a specific path.
+CpuVariant chooseCpuVariant();
+
+const char* getCpuVariantName(CpuVariant variant);
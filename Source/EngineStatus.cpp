@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    EngineStatus.cpp
+    Created: 20 Oct 2026 10:12:37am
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "EngineStatus.h"
+
+namespace
+{
+    juce::String voiceSeconds(const JX11AudioProcessor::VoiceUsage& usage, double sampleRate)
+    {
+        const double rendered = double(usage.rendered.load(std::memory_order_relaxed)) / sampleRate;
+        const double saved = double(usage.saved.load(std::memory_order_relaxed)) / sampleRate;
+        return juce::String(rendered, 1) + " s rendered, " + juce::String(saved, 1) + " s saved";
+    }
+}
+
+//==============================================================================
+EngineStatus::EngineStatus(JX11AudioProcessor& processor) : audioProcessor(processor)
+{
+    setOpaque(false);
+    setInterceptsMouseClicks(false, false);
+    timerCallback();
+    startTimerHz(4);
+}
+
+EngineStatus::~EngineStatus()
+{
+}
+
+void EngineStatus::timerCallback()
+{
+    juce::StringArray newLines;
+
+    const auto guard = audioProcessor.getOutputGuardCounts();
+    newLines.add("Output guard: " + juce::String(guard.nonFinite) + " NaN/Inf, "
+                 + juce::String(guard.screaming) + " muted, " + juce::String(guard.clamped) + " clipped");
+
+    const auto& midi = audioProcessor.getMidiEventStats();
+    newLines.add("MIDI: " + juce::String(midi.received.load(std::memory_order_relaxed)) + " received, "
+                 + juce::String(midi.coalesced.load(std::memory_order_relaxed)) + " coalesced, "
+                 + juce::String(midi.redundant.load(std::memory_order_relaxed)) + " redundant, "
+                 + juce::String(midi.ignored.load(std::memory_order_relaxed)) + " ignored");
+
+    // Voice time per preset, or per part with Multi on. Parts that haven't
+    // played anything are left out.
+    const double sampleRate = audioProcessor.getSampleRate() > 0.0 ? audioProcessor.getSampleRate() : 44100.0;
+    if(audioProcessor.isMultiTimbral()){
+        juce::String partsLine = "Voices by part:";
+        for(int ch = 0; ch < 16; ++ch){
+            const auto& usage = audioProcessor.getPartVoiceUsage(ch);
+            if(usage.rendered.load(std::memory_order_relaxed) != 0){
+                partsLine << " " << (ch + 1) << ": " << voiceSeconds(usage, sampleRate) << ";";
+            }
+        }
+        newLines.add(partsLine.trimCharactersAtEnd(";"));
+    }else{
+        const int program = audioProcessor.getCurrentProgram();
+        newLines.add("Voices (" + audioProcessor.getProgramName(program) + "): "
+                     + voiceSeconds(audioProcessor.getVoiceUsage(program), sampleRate));
+    }
+
+    // Share of real time the audio thread spends feeding the meter.
+    newLines.add("Meter feed: " + juce::String(audioProcessor.meterFeed.getAudioThreadLoad() * 100.0f, 3)
+                 + "% of the audio thread");
+
+    // Only repaint when something changed.
+    if(newLines != lines){
+        lines = newLines;
+        repaint();
+    }
+}
+
+void EngineStatus::paint (juce::Graphics& g)
+{
+    g.setColour (juce::Colours::white.withAlpha(0.7f));
+    g.setFont (12.0f);
+
+    auto area = getLocalBounds();
+    for (const auto& line : lines){
+        g.drawText (line, area.removeFromTop(15), juce::Justification::centredLeft, true);
+    }
+}
@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    EngineStatus.h
+    Created: 20 Oct 2026 10:12:37am
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//==============================================================================
+/*
+    A few lines of engine telemetry under the meter. The counters are read
+    from the processor a few times a second on the message thread; nothing
+    here touches the audio thread.
+*/
+class EngineStatus  : public juce::Component, private juce::Timer
+{
+public:
+    EngineStatus(JX11AudioProcessor& processor);
+    ~EngineStatus() override;
+
+    void paint (juce::Graphics&) override;
+
+private:
+    void timerCallback() override;
+
+    JX11AudioProcessor& audioProcessor;
+    juce::StringArray lines;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EngineStatus)
+};
@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    Ensemble.h
+    Created: 19 Oct 2026 4:58:20pm
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DspKernels.h"
+
+// Juno-style chorus: each channel runs through a short delay swept by a
+// triangle LFO, the left and right sweeps in opposite phase, and is mixed
+// with the dry signal. Mode I is a slow, gentle sweep, mode II a faster one.
+//
+// The LFO is computed a sub-block at a time into a list of read positions,
+// and the interpolated reads then go through the dispatched delay kernel.
+// The delay lines are sized in prepare(), so process() never allocates.
+template <typename SampleType>
+class Ensemble
+{
+public:
+    static constexpr int NUM_MODES = 2;
+
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+
+        // Longest delay plus a sub-block of writes ahead of the reads.
+        const int needed = int(std::ceil(sampleRate * MAX_DELAY_MS * 0.001)) + BLOCK_SIZE;
+        lineSize = juce::nextPowerOfTwo(needed);
+
+        // One extra sample so the interpolation never has to wrap.
+        for(auto& line : lines){
+            line.assign(size_t(lineSize + 1), SampleType(0));
+        }
+
+        updateSettings();
+        reset();
+    }
+
+    void reset()
+    {
+        for(auto& line : lines){
+            std::fill(line.begin(), line.end(), SampleType(0));
+        }
+        writeIndex = 0;
+        phase = 0;
+    }
+
+    // 0 is off, 1 and 2 are the chorus modes.
+    void setMode(int newMode)
+    {
+        newMode = std::clamp(newMode, 0, NUM_MODES);
+
+        // Don't play back whatever was in the lines when it was switched off.
+        if(mode == 0 && newMode != 0){
+            reset();
+        }
+        mode = newMode;
+        updateSettings();
+    }
+
+    bool isActive() const
+    {
+        return mode != 0 && lineSize > 0;
+    }
+
+    // right may be nullptr for a mono bus.
+    void process(SampleType* left, SampleType* right, int sampleCount, const DspKernels<SampleType>& kernels)
+    {
+        for(int start = 0; start < sampleCount; start += BLOCK_SIZE){
+            const int count = std::min(BLOCK_SIZE, sampleCount - start);
+
+            processChannel(lines[0].data(), left + start, count, SampleType(0), kernels);
+            if(right != nullptr){
+                processChannel(lines[1].data(), right + start, count, SampleType(0.5), kernels);
+            }
+
+            writeIndex = (writeIndex + count) & (lineSize - 1);
+            phase += SampleType(count) * phaseInc;
+            phase -= std::floor(phase);
+        }
+    }
+
+private:
+    static constexpr int BLOCK_SIZE = 64;
+    static constexpr double MAX_DELAY_MS = 8.0;
+
+    struct Settings
+    {
+        double rate;     // Hz
+        double center;   // ms
+        double depth;    // ms
+    };
+
+    static constexpr Settings settings[NUM_MODES] = {
+        { 0.513, 3.5, 1.85 },
+        { 0.863, 3.5, 1.85 },
+    };
+
+    void updateSettings()
+    {
+        if(mode == 0){ return; }
+
+        const Settings& s = settings[mode - 1];
+        phaseInc = SampleType(s.rate / sampleRate);
+        center = SampleType(s.center * 0.001 * sampleRate);
+        depth = SampleType(s.depth * 0.001 * sampleRate);
+    }
+
+    void processChannel(SampleType* line, SampleType* samples, int count, SampleType phaseOffset,
+                        const DspKernels<SampleType>& kernels)
+    {
+        const int mask = lineSize - 1;
+
+        for(int i = 0; i < count; ++i){
+            const int index = (writeIndex + i) & mask;
+            line[index] = samples[i];
+            if(index == 0){ line[lineSize] = samples[i]; }
+        }
+
+        // Triangle LFO from -1 to 1, turned into read positions that trail
+        // the write position by the swept delay time.
+        const SampleType size = SampleType(lineSize);
+        for(int i = 0; i < count; ++i){
+            SampleType p = phase + phaseOffset + SampleType(i) * phaseInc;
+            p -= std::floor(p);
+            const SampleType triangle = SampleType(4) * std::abs(p - SampleType(0.5)) - SampleType(1);
+            SampleType position = SampleType(writeIndex + i) - (center + depth * triangle);
+            position += (position < SampleType(0)) ? size : SampleType(0);
+            position -= (position >= size) ? size : SampleType(0);
+            positions[i] = position;
+        }
+
+        kernels.readDelay(line, positions, wet, count);
+
+        for(int i = 0; i < count; ++i){
+            samples[i] = (samples[i] + wet[i]) * SampleType(0.7071067812);
+        }
+    }
+
+    double sampleRate = 44100.0;
+    int mode = 0;
+
+    std::array<std::vector<SampleType>, 2> lines;
+    int lineSize = 0;
+    int writeIndex = 0;
+
+    SampleType phase = 0;
+    SampleType phaseInc = 0;
+    SampleType center = 0;
+    SampleType depth = 0;
+
+    SampleType positions[BLOCK_SIZE];
+    SampleType wet[BLOCK_SIZE];
+};
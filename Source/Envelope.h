@@ -10,16 +10,20 @@
 
 #pragma once
 
+#include <cmath>
+#include "DspKernels.h"
+
 const float SILENCE = 0.0001f;
 
+template <typename SampleType>
 class Envelope
 {
 public:
-    float nextValue()
+    SampleType nextValue()
     {
         level = multiplier * (level - target) + target;
         
-        if(level + target > 3.0f){
+        if(level + target > SampleType(3)){
             multiplier = decayMultiplier;
             target = sustainLevel;
         }
@@ -27,44 +31,87 @@ public:
         return level;
     }
     
+    // Renders a run of values for ENVELOPE_LANES envelopes at once, one
+    // lane per envelope, into frames[n * ENVELOPE_LANES + lane]. A null
+    // envelope leaves its lane unused and its state alone. The values are
+    // bit-identical to calling nextValue() on each envelope.
+    static void renderLanes(Envelope* const (&envelopes)[ENVELOPE_LANES], SampleType* frames, int sampleCount,
+                            const DspKernels<SampleType>& kernels)
+    {
+        SampleType level[ENVELOPE_LANES], multiplier[ENVELOPE_LANES], target[ENVELOPE_LANES];
+        SampleType decay[ENVELOPE_LANES], sustain[ENVELOPE_LANES];
+        for(int lane = 0; lane < ENVELOPE_LANES; ++lane){
+            const Envelope* env = envelopes[lane];
+            level[lane] = (env != nullptr) ? env->level : SampleType(0);
+            multiplier[lane] = (env != nullptr) ? env->multiplier : SampleType(0);
+            target[lane] = (env != nullptr) ? env->target : SampleType(0);
+            decay[lane] = (env != nullptr) ? env->decayMultiplier : SampleType(0);
+            sustain[lane] = (env != nullptr) ? env->sustainLevel : SampleType(0);
+        }
+        
+        kernels.envelopeLanes(level, multiplier, target, decay, sustain, frames, sampleCount);
+        
+        for(int lane = 0; lane < ENVELOPE_LANES; ++lane){
+            if(Envelope* env = envelopes[lane]){
+                env->level = level[lane];
+                env->multiplier = multiplier[lane];
+                env->target = target[lane];
+            }
+        }
+    }
+    
     void reset()
     {
-        level = 0.0f;
-        target = 0.0f;
-        multiplier = 0.0f;
+        level = 0;
+        target = 0;
+        multiplier = 0;
     }
     
     void release()
     {
-        target = 0.0f;
+        target = 0;
         multiplier = releaseMultiplier;
     }
     
     inline bool isActive() const
     {
-        return level > SILENCE;
+        return level > SampleType(SILENCE);
     }
     
     inline bool isInAttack() const
     {
-        return target >= 2.0f;
+        return target >= SampleType(2);
+    }
+    
+    // Heading for zero: released, or decaying to a sustain level of zero.
+    inline bool isFadingOut() const
+    {
+        return target == SampleType(0);
+    }
+    
+    // How many more samples the level would take to fall below SILENCE.
+    SampleType samplesUntilSilent() const
+    {
+        if(level <= SampleType(SILENCE) || multiplier <= 0){ return 0; }
+        if(multiplier >= 1){ return SampleType(1e9); }
+        return std::log(SampleType(SILENCE) / level) / std::log(multiplier);
     }
     
     void attack()
     {
-        level += SILENCE + SILENCE;
-        target = 2.0f;
+        level += SampleType(SILENCE + SILENCE);
+        target = 2;
         multiplier = attackMultiplier;
     }
     
-    float level;
+    SampleType level;
     
-    float attackMultiplier;
-    float decayMultiplier;
-    float sustainLevel;
-    float releaseMultiplier;
+    SampleType attackMultiplier;
+    SampleType decayMultiplier;
+    SampleType sustainLevel;
+    SampleType releaseMultiplier;
     
 private:
-    float multiplier;
-    float target;
+    SampleType multiplier;
+    SampleType target;
 };
@@ -0,0 +1,201 @@
+/*
+  ==============================================================================
+
+    FdnReverb.h
+    Created: 19 Oct 2026 5:41:09pm
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DspKernels.h"
+
+// Feedback delay network reverb: eight delay lines of 23 to 58 ms, each with
+// a one-pole damping filter, fed back through a Hadamard matrix. The gain
+// of every line is set so the tail falls by 60 dB in the decay time.
+//
+// Because the shortest line is longer than a sub-block, a whole sub-block
+// can be read from every line at once, run through the matrix a sample at a
+// time with the eight lines side by side in SIMD lanes, and written back.
+// The lines are allocated in prepare(), so process() never allocates.
+//
+// Once the input has been silent and every line has been read back below
+// the silence threshold for a full trip round the longest line, the lines
+// are cleared and processing stops until sound comes in again. A decaying
+// tail therefore never reaches the denormal range, and an idle reverb costs
+// nothing.
+template <typename SampleType>
+class FdnReverb
+{
+public:
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+
+        for(int l = 0; l < FDN_LINES; ++l){
+            lengths[l] = std::max(BLOCK_SIZE, int(std::round(LINE_LENGTHS[l] * sampleRate / 48000.0)));
+            lines[l].assign(size_t(lengths[l]), SampleType(0));
+            inputGains[l] = (l & 1) ? SampleType(-0.25) : SampleType(0.25);
+        }
+
+        // Rolls off the tail above about 5 kHz.
+        damping = SampleType(1.0 - std::exp(-juce::MathConstants<double>::twoPi * 5000.0 / sampleRate));
+
+        // The gains depend on the line lengths, so work them out again.
+        const float seconds = decayTime;
+        decayTime = 0.0f;
+        setDecayTime(seconds);
+        reset();
+    }
+
+    void reset()
+    {
+        for(int l = 0; l < FDN_LINES; ++l){
+            std::fill(lines[l].begin(), lines[l].end(), SampleType(0));
+        }
+        std::fill(std::begin(lowpass), std::end(lowpass), SampleType(0));
+        std::fill(std::begin(indices), std::end(indices), 0);
+        
+        // Empty lines, so the tail is already over.
+        silentSamples = lengths[FDN_LINES - 1];
+    }
+
+    // Seconds for the tail to fall by 60 dB.
+    void setDecayTime(float seconds)
+    {
+        if(seconds == decayTime){ return; }
+        decayTime = seconds;
+
+        for(int l = 0; l < FDN_LINES; ++l){
+            gains[l] = SampleType(std::pow(10.0, -3.0 * lengths[l] / (double(seconds) * sampleRate)));
+        }
+    }
+
+    // 0 switches the reverb off completely.
+    void setMix(float newMix)
+    {
+        // Don't play back an old tail when it comes back on.
+        if(mix == 0.0f && newMix != 0.0f){
+            reset();
+        }
+        mix = newMix;
+    }
+
+    bool isActive() const
+    {
+        return mix != 0.0f && lengths[0] > 0;
+    }
+
+    // right may be nullptr for a mono bus.
+    void process(SampleType* left, SampleType* right, int sampleCount, const DspKernels<SampleType>& kernels)
+    {
+        const SampleType wetGain = SampleType(mix);
+
+        for(int start = 0; start < sampleCount; start += BLOCK_SIZE){
+            const int count = std::min(BLOCK_SIZE, sampleCount - start);
+            SampleType* l = left + start;
+            SampleType* r = (right != nullptr) ? right + start : nullptr;
+
+            SampleType inputPeak = 0;
+            for(int i = 0; i < count; ++i){
+                input[i] = (r != nullptr) ? (l[i] + r[i]) * SampleType(0.5) : l[i];
+                inputPeak = std::max(inputPeak, std::abs(input[i]));
+            }
+
+            const bool silentInput = inputPeak <= SampleType(SILENT);
+            if(silentInput && silentSamples >= lengths[FDN_LINES - 1]){
+                continue;
+            }
+
+            transferLines(count, true);
+            
+            SampleType linePeak = 0;
+            for(int i = 0; i < count * FDN_LINES; ++i){
+                linePeak = std::max(linePeak, std::abs(frames[i]));
+            }
+            
+            kernels.feedbackMatrix(frames, lowpass, gains, inputGains, damping, input, wetLeft, wetRight, count);
+            transferLines(count, false);
+            advanceLines(count);
+
+            if(silentInput && linePeak <= SampleType(SILENT)){
+                silentSamples += count;
+                if(silentSamples >= lengths[FDN_LINES - 1]){
+                    reset();
+                }
+            }else{
+                silentSamples = 0;
+            }
+
+            if(r != nullptr){
+                for(int i = 0; i < count; ++i){
+                    l[i] += wetLeft[i] * wetGain;
+                    r[i] += wetRight[i] * wetGain;
+                }
+            }else{
+                for(int i = 0; i < count; ++i){
+                    l[i] += (wetLeft[i] + wetRight[i]) * SampleType(0.5) * wetGain;
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr int BLOCK_SIZE = 64;
+
+    // -160 dB, far below anything audible but well above the denormals.
+    static constexpr double SILENT = 1e-8;
+
+    // Mutually prime lengths in samples at 48 kHz.
+    static constexpr double LINE_LENGTHS[FDN_LINES] = { 1109, 1327, 1559, 1801, 2039, 2273, 2503, 2777 };
+
+    // Copies a sub-block from every line into frames, or back. Each line is
+    // exactly as long as its delay, so the oldest sample is read at the
+    // same index the new one is written to.
+    void transferLines(int count, bool read)
+    {
+        for(int l = 0; l < FDN_LINES; ++l){
+            SampleType* line = lines[l].data();
+            const int length = lengths[l];
+            int index = indices[l];
+            for(int i = 0; i < count; ++i){
+                if(read){
+                    frames[i * FDN_LINES + l] = line[index];
+                }else{
+                    line[index] = frames[i * FDN_LINES + l];
+                }
+                if(++index == length){ index = 0; }
+            }
+        }
+    }
+
+    void advanceLines(int count)
+    {
+        for(int l = 0; l < FDN_LINES; ++l){
+            indices[l] += count;
+            if(indices[l] >= lengths[l]){ indices[l] -= lengths[l]; }
+        }
+    }
+
+    double sampleRate = 44100.0;
+    float mix = 0.0f;
+    float decayTime = 2.0f;
+
+    std::array<std::vector<SampleType>, FDN_LINES> lines;
+    int lengths[FDN_LINES] = {};
+    int indices[FDN_LINES] = {};
+    int silentSamples = 0;
+
+    SampleType gains[FDN_LINES] = {};
+    SampleType inputGains[FDN_LINES] = {};
+    SampleType lowpass[FDN_LINES] = {};
+    SampleType damping = 0;
+
+    SampleType frames[BLOCK_SIZE * FDN_LINES];
+    SampleType input[BLOCK_SIZE];
+    SampleType wetLeft[BLOCK_SIZE];
+    SampleType wetRight[BLOCK_SIZE];
+};
@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include "CutoffTable.h"
+
 class Filter
 {
 public:
@@ -18,10 +20,15 @@ public:
     void updateCoefficients(float cutoff, float Q)
     {
         g = std::tan(PI * cutoff / sampleRate);
-        k = 1.0f / Q;
-        a1 = 1.0f / (1.0f + g * (g + k));
-        a2 = g * a1;
-        a3 = g * a2;
+        updateGains(Q);
+    }
+    
+    // Same, but with the cutoff as a natural log and g read from a table
+    // prepared for this sample rate instead of computed with tan().
+    void updateCoefficients(const CutoffTable<float>& table, float logCutoff, float Q)
+    {
+        g = table.getSvfCoefficient(logCutoff);
+        updateGains(Q);
     }
     
     void reset()
@@ -47,6 +54,14 @@ public:
     }
     
 private:
+    void updateGains(float Q)
+    {
+        k = 1.0f / Q;
+        a1 = 1.0f / (1.0f + g * (g + k));
+        a2 = g * a1;
+        a3 = g * a2;
+    }
+    
     const float PI = 3.1415926535897932f;
     
     float g, k, a1, a2, a3; // Filter coefficients
@@ -11,19 +11,146 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "SharedResources.h"
+#include "CutoffTable.h"
 
-class FilterLadder : public juce::dsp::LadderFilter<float>
+// Same topology as juce::dsp::LadderFilter, but the cutoff and resonance are
+// ramped linearly over one control period instead of through fixed 50 ms
+// smoothers, so every control-rate update is interpolated per sample.
+template <typename SampleType>
+class FilterLadder
 {
 public:
-    void updateCoefficients(float cutoff, float Q)
+    FilterLadder()
     {
-        setCutoffFrequencyHz(cutoff);
-        setResonance(std::clamp(Q / 30.0f, 0.0f, 1.0f));
+        setDrive(SampleType(1.2));
+        setMode(juce::dsp::LadderFilterMode::LPF12);
     }
-    
-    float render(float x)
+
+    void setMode(juce::dsp::LadderFilterMode mode)
+    {
+        switch(mode){
+            case juce::dsp::LadderFilterMode::LPF12: A = {{ 0,  0,  1,  0, 0 }}; comp = SampleType(0.5); break;
+            case juce::dsp::LadderFilterMode::HPF12: A = {{ 1, -2,  1,  0, 0 }}; comp = 0; break;
+            case juce::dsp::LadderFilterMode::BPF12: A = {{ 0,  0, -1,  1, 0 }}; comp = SampleType(0.5); break;
+            case juce::dsp::LadderFilterMode::LPF24: A = {{ 0,  0,  0,  0, 1 }}; comp = SampleType(0.5); break;
+            case juce::dsp::LadderFilterMode::HPF24: A = {{ 1, -4,  6, -4, 1 }}; comp = 0; break;
+            case juce::dsp::LadderFilterMode::BPF24: A = {{ 0,  0,  1, -2, 1 }}; comp = SampleType(0.5); break;
+            default: jassertfalse; break;
+        }
+
+        for(auto& a : A){ a *= SampleType(1.2); }
+    }
+
+    // The table must have been prepared for the same sample rate, and must
+    // outlive the filter.
+    void prepare(const juce::dsp::ProcessSpec& spec, const CutoffTable<SampleType>& table)
     {
-        updateSmoothers();
-        return processSample(x,0);
+        juce::ignoreUnused(spec);
+        cutoffTable = &table;
+        reset();
     }
+
+    void setRampLength(int samples)
+    {
+        rampLength = std::max(samples, 1);
+        inverseRampLength = SampleType(1) / SampleType(rampLength);
+    }
+
+    // logCutoff is the natural log of the cutoff in Hz.
+    void updateCoefficients(SampleType logCutoff, SampleType Q)
+    {
+        SampleType targetCutoff = cutoffTable->getLadderCoefficient(logCutoff);
+        SampleType targetResonance = juce::jmap(std::clamp(Q / SampleType(30), SampleType(0), SampleType(1)), SampleType(0.1), SampleType(1));
+
+        if(snapToTarget){
+            cutoffTransform = targetCutoff;
+            scaledResonance = targetResonance;
+            rampRemaining = 0;
+            snapToTarget = false;
+        }else{
+            cutoffInc = (targetCutoff - cutoffTransform) * inverseRampLength;
+            resonanceInc = (targetResonance - scaledResonance) * inverseRampLength;
+            rampRemaining = rampLength;
+        }
+    }
+
+    void reset()
+    {
+        s.fill(0);
+        rampRemaining = 0;
+        snapToTarget = true;
+    }
+
+    // Clears the state once all of it has decayed to nothing, for when the
+    // input stops and FTZ is not available. A single stage passing through
+    // zero is left alone. Cheap enough to call once per run.
+    void snapToZero()
+    {
+        SampleType peak = 0;
+        for(auto state : s){
+            peak = std::max(peak, std::abs(state));
+        }
+        if(peak < SampleType(1e-8)){
+            s.fill(0);
+        }
+    }
+
+    SampleType render(SampleType x)
+    {
+        if(rampRemaining > 0){
+            cutoffTransform += cutoffInc;
+            scaledResonance += resonanceInc;
+            --rampRemaining;
+        }
+
+        const auto& saturation = tables->template getTanh<SampleType>();
+
+        const SampleType a1 = cutoffTransform;
+        const SampleType g = SampleType(1) - a1;
+        const SampleType b0 = g * SampleType(0.76923076923);
+        const SampleType b1 = g * SampleType(0.23076923076);
+
+        const SampleType dx = gain * saturation(drive * x);
+        const SampleType a = dx + scaledResonance * SampleType(-4) * (gain2 * saturation(drive2 * s[4]) - dx * comp);
+
+        const SampleType b = b1 * s[0] + a1 * s[1] + b0 * a;
+        const SampleType c = b1 * s[1] + a1 * s[2] + b0 * b;
+        const SampleType d = b1 * s[2] + a1 * s[3] + b0 * c;
+        const SampleType e = b1 * s[3] + a1 * s[4] + b0 * d;
+
+        s[0] = a;
+        s[1] = b;
+        s[2] = c;
+        s[3] = d;
+        s[4] = e;
+
+        return a * A[0] + b * A[1] + c * A[2] + d * A[3] + e * A[4];
+    }
+
+private:
+    void setDrive(SampleType newDrive)
+    {
+        drive = newDrive;
+        gain = std::pow(drive, SampleType(-2.642)) * SampleType(0.6103) + SampleType(0.3903);
+        drive2 = drive * SampleType(0.04) + SampleType(0.96);
+        gain2 = std::pow(drive2, SampleType(-2.642)) * SampleType(0.6103) + SampleType(0.3903);
+    }
+
+    juce::SharedResourcePointer<SharedTables> tables;
+
+    std::array<SampleType, 5> A;
+    std::array<SampleType, 5> s {};
+    SampleType comp;
+    SampleType drive, drive2, gain, gain2;
+
+    const CutoffTable<SampleType>* cutoffTable = nullptr;
+    SampleType cutoffTransform = 1;
+    SampleType scaledResonance = SampleType(0.1);
+    SampleType cutoffInc = 0;
+    SampleType resonanceInc = 0;
+    int rampLength = 32;
+    SampleType inverseRampLength = SampleType(1) / SampleType(32);
+    int rampRemaining = 0;
+    bool snapToTarget = true;
 };
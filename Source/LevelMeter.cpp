@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    LevelMeter.cpp
+    Created: 19 Oct 2026 11:58:03am
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "LevelMeter.h"
+
+static constexpr float minDecibels = -60.0f;
+static constexpr float peakFalloff = 0.9f;    // per refresh
+
+static float levelToProportion(float level)
+{
+    float db = juce::Decibels::gainToDecibels(level, minDecibels);
+    return juce::jlimit(0.0f, 1.0f, (db - minDecibels) / -minDecibels);
+}
+
+//==============================================================================
+LevelMeter::LevelMeter(MeterFeed& feed) : meterFeed(feed)
+{
+    setOpaque(false);
+}
+
+LevelMeter::~LevelMeter()
+{
+}
+
+void LevelMeter::refresh()
+{
+    // What the bars show now, to tell whether anything moved.
+    const float shownLevels[4] = { levelToProportion(peakLeft), levelToProportion(peakRight),
+                                   levelToProportion(rmsLeft), levelToProportion(rmsRight) };
+
+    MeterFrame frames[64];
+    int numFrames = meterFeed.pullFrames(frames, 64);
+
+    // Peaks fall back slowly, RMS shows the newest frame.
+    peakLeft *= peakFalloff;
+    peakRight *= peakFalloff;
+    for (int i = 0; i < numFrames; ++i){
+        peakLeft = std::max(peakLeft, frames[i].peakLeft);
+        peakRight = std::max(peakRight, frames[i].peakRight);
+    }
+    if (numFrames > 0){
+        rmsLeft = frames[numFrames - 1].rmsLeft;
+        rmsRight = frames[numFrames - 1].rmsRight;
+    }
+
+    int numSamples = meterFeed.pullScope(pullBuffer.data(), int(pullBuffer.size()));
+    for (int i = 0; i < numSamples; ++i){
+        scopeBuffer[size_t(scopeWritePosition)] = pullBuffer[size_t(i)];
+        scopeWritePosition = (scopeWritePosition + 1) % SCOPE_LENGTH;
+    }
+
+    // The trace scrolls with every new sample, unless it is a flat line. The
+    // host keeps sending silence while nothing plays, so that is common.
+    bool changed = false;
+    if (numSamples > 0){
+        const bool wasSilent = scopeSilent;
+        scopeSilent = std::all_of(scopeBuffer.begin(), scopeBuffer.end(), [](float x) { return x == 0.0f; });
+        changed = !(wasSilent && scopeSilent);
+    }
+
+    changed = changed
+           || shownLevels[0] != levelToProportion(peakLeft) || shownLevels[1] != levelToProportion(peakRight)
+           || shownLevels[2] != levelToProportion(rmsLeft) || shownLevels[3] != levelToProportion(rmsRight);
+
+    if (changed){
+        repaint();
+    }
+}
+
+void LevelMeter::paint (juce::Graphics& g)
+{
+    g.setColour (juce::Colours::black.withAlpha(0.6f));
+    g.fillRect (scopeArea);
+    g.fillRect (meterArea);
+
+    // Oscilloscope, oldest sample on the left.
+    juce::Path path;
+    const float midY = float(scopeArea.getCentreY());
+    const float halfHeight = float(scopeArea.getHeight()) * 0.5f;
+    const float xScale = float(scopeArea.getWidth()) / float(SCOPE_LENGTH - 1);
+    for (int i = 0; i < SCOPE_LENGTH; ++i){
+        float sample = juce::jlimit(-1.0f, 1.0f, scopeBuffer[size_t((scopeWritePosition + i) % SCOPE_LENGTH)]);
+        float x = float(scopeArea.getX()) + float(i) * xScale;
+        float y = midY - sample * halfHeight;
+        if (i == 0){
+            path.startNewSubPath(x, y);
+        }else{
+            path.lineTo(x, y);
+        }
+    }
+    g.setColour (getLookAndFeel().findColour(juce::Slider::rotarySliderFillColourId));
+    g.strokePath (path, juce::PathStrokeType(1.0f));
+
+    // Meter bars: RMS filled, peak as a line.
+    auto bars = meterArea.reduced(2);
+    auto leftBar = bars.removeFromLeft(bars.getWidth() / 2).reduced(1, 0).toFloat();
+    auto rightBar = bars.reduced(1, 0).toFloat();
+
+    auto drawBar = [&](juce::Rectangle<float> bar, float rms, float peak){
+        float rmsHeight = bar.getHeight() * levelToProportion(rms);
+        float peakY = bar.getBottom() - bar.getHeight() * levelToProportion(peak);
+        g.setColour (juce::Colour(90, 180, 240));
+        g.fillRect (bar.withTop(bar.getBottom() - rmsHeight));
+        g.setColour (peak >= 1.0f ? juce::Colours::red : juce::Colours::white);
+        g.drawLine (bar.getX(), peakY, bar.getRight(), peakY, 2.0f);
+    };
+    drawBar(leftBar, rmsLeft, peakLeft);
+    drawBar(rightBar, rmsRight, peakRight);
+}
+
+void LevelMeter::resized()
+{
+    auto bounds = getLocalBounds();
+    meterArea = bounds.removeFromRight(24);
+    bounds.removeFromRight(6);
+    scopeArea = bounds;
+}
@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    LevelMeter.h
+    Created: 19 Oct 2026 11:58:03am
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MeterFeed.h"
+
+//==============================================================================
+/*
+    Output meter and oscilloscope. Drains the processor's MeterFeed once per
+    display refresh, so the audio thread never waits on the GUI.
+*/
+class LevelMeter  : public juce::Component
+{
+public:
+    LevelMeter(MeterFeed& feed);
+    ~LevelMeter() override;
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+    void refresh();
+
+    MeterFeed& meterFeed;
+    juce::VBlankAttachment vblankAttachment { this, [this] { refresh(); } };
+
+    static constexpr int SCOPE_LENGTH = 512;
+    std::array<float, SCOPE_LENGTH> scopeBuffer {};
+    int scopeWritePosition = 0;
+    bool scopeSilent = true;
+    std::array<float, 1024> pullBuffer {};
+
+    float peakLeft = 0.0f;
+    float peakRight = 0.0f;
+    float rmsLeft = 0.0f;
+    float rmsRight = 0.0f;
+
+    juce::Rectangle<int> scopeArea;
+    juce::Rectangle<int> meterArea;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeter)
+};
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    Limiter.h
+    Created: 19 Oct 2026 10:12:40am
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+
+// Soft limiter with a 4x oversampled true-peak detector. The inter-sample
+// peaks are estimated with Catmull-Rom interpolation at 1/4, 1/2 and 3/4
+// between each pair of input samples, like a BS.1770 true-peak meter. The
+// audio is delayed by LOOKAHEAD samples so that the gain for a sample has
+// seen the segments on both sides of it: the one after it needs the sample
+// after that too. Gain reduction has instant attack and an exponential
+// release, and a soft knee catches what slips through while the gain
+// changes within a segment. That keeps the interpolated peaks at the
+// ceiling; Catmull-Rom reads low in the top octave, so a meter with a
+// longer interpolation filter can find higher peaks in bright material.
+template <typename SampleType>
+class TruePeakLimiter
+{
+public:
+    static constexpr int LOOKAHEAD = 2;
+
+    TruePeakLimiter()
+    {
+        for (int k = 0; k < PHASES; ++k){
+            SampleType t = SampleType(k + 1) / SampleType(PHASES + 1);
+            SampleType t2 = t * t;
+            SampleType t3 = t2 * t;
+            weights[k][0] = SampleType(0.5) * (-t3 + SampleType(2) * t2 - t);
+            weights[k][1] = SampleType(0.5) * (SampleType(3) * t3 - SampleType(5) * t2 + SampleType(2));
+            weights[k][2] = SampleType(0.5) * (SampleType(-3) * t3 + SampleType(4) * t2 + t);
+            weights[k][3] = SampleType(0.5) * (t3 - t2);
+        }
+    }
+
+    void prepare(float sampleRate)
+    {
+        releaseCoeff = SampleType(std::exp(-1.0f / (0.05f * sampleRate)));
+        reset();
+    }
+
+    void reset()
+    {
+        gain = 1;
+        previousPeak = 0;
+        std::fill(std::begin(historyLeft), std::end(historyLeft), SampleType(0));
+        std::fill(std::begin(historyRight), std::end(historyRight), SampleType(0));
+    }
+
+    void process(SampleType* left, SampleType* right, int sampleCount)
+    {
+        for (int i = 0; i < sampleCount; ++i){
+            SampleType l = left[i];
+            SampleType r = (right != nullptr) ? right[i] : l;
+
+            // The sample going out is history[1]. Its segment to history[2]
+            // is measured now, the one from history[0] was the step before.
+            SampleType segmentPeak = std::max(truePeak(historyLeft, l), truePeak(historyRight, r));
+            SampleType peak = std::max(segmentPeak, previousPeak);
+            previousPeak = segmentPeak;
+
+            SampleType target = (peak > ceiling) ? ceiling / peak : SampleType(1);
+            gain = (target < gain) ? target : target + releaseCoeff * (gain - target);
+
+            left[i] = softClip(historyLeft[1] * gain);
+            if (right != nullptr){
+                right[i] = softClip(historyRight[1] * gain);
+            }
+        }
+    }
+
+    // With the limiter off the audio still goes through the delay, so the
+    // latency doesn't change and turning it back on doesn't click.
+    void bypass(SampleType* left, SampleType* right, int sampleCount)
+    {
+        for (int i = 0; i < sampleCount; ++i){
+            SampleType l = left[i];
+            SampleType r = (right != nullptr) ? right[i] : l;
+            push(historyLeft, l);
+            push(historyRight, r);
+
+            left[i] = historyLeft[1];
+            if (right != nullptr){
+                right[i] = historyRight[1];
+            }
+        }
+        gain = 1;
+        previousPeak = 0;
+    }
+
+private:
+    static constexpr int PHASES = 3;
+    static constexpr SampleType ceiling = SampleType(0.966f);   // -0.3 dBTP
+    static constexpr SampleType knee = SampleType(0.85f);
+
+    static void push(SampleType* history, SampleType x)
+    {
+        history[0] = history[1];
+        history[1] = history[2];
+        history[2] = history[3];
+        history[3] = x;
+    }
+
+    // Peak of the segment from history[1] to history[2], ends included,
+    // after x has been pushed.
+    SampleType truePeak(SampleType* history, SampleType x)
+    {
+        push(history, x);
+
+        SampleType peak = std::max(std::abs(history[1]), std::abs(history[2]));
+        for (int k = 0; k < PHASES; ++k){
+            SampleType y = weights[k][0] * history[0] + weights[k][1] * history[1]
+                    + weights[k][2] * history[2] + weights[k][3] * history[3];
+            peak = std::max(peak, std::abs(y));
+        }
+        return peak;
+    }
+
+    static SampleType softClip(SampleType x)
+    {
+        SampleType a = std::abs(x);
+        if (a <= knee) { return x; }
+        SampleType y = knee + (ceiling - knee) * std::tanh((a - knee) / (ceiling - knee));
+        return std::copysign(y, x);
+    }
+
+    SampleType weights[PHASES][4];
+    SampleType historyLeft[4];
+    SampleType historyRight[4];
+    SampleType releaseCoeff = SampleType(0.9995f);
+    SampleType gain = 1;
+    SampleType previousPeak = 0;
+};
@@ -23,8 +23,7 @@ LookAndFeel::LookAndFeel()
     setColour(juce::TextButton::textColourOnId, juce::Colour(255, 255, 255));
     setColour(juce::ComboBox::outlineColourId, juce::Colour(180, 180, 180));
     
-    juce::Typeface::Ptr typeface = juce::Typeface::createSystemTypefaceFor(BinaryData::LatoMedium_ttf, BinaryData::LatoMedium_ttfSize);
-    setDefaultSansSerifTypeface(typeface);
+    setDefaultSansSerifTypeface(fonts->latoMedium);
 }
 
 void LookAndFeel::drawRotarySlider(juce::Graphics& g, int x, int y, int width, int /*height*/, float sliderPos, float rotaryStartAngle, float rotaryEndAngle, juce::Slider& slider){
@@ -32,10 +31,47 @@ void LookAndFeel::drawRotarySlider(juce::Graphics& g, int x, int y, int width, i
     auto outlineColor = slider.findColour(juce::Slider::rotarySliderOutlineColourId);
     auto fillColor = slider.findColour(juce::Slider::rotarySliderFillColourId);
     auto dialColor = slider.findColour(juce::Slider::thumbColourId);
-    auto bounds = juce::Rectangle<int>(x, y, width, width).toFloat().withTrimmedLeft(16.0f).withTrimmedRight(16.0f).withTrimmedTop(0.0f).withTrimmedBottom(8.0f);
+    auto bounds = juce::Rectangle<int>(x, y, width, width).withTrimmedLeft(16).withTrimmedRight(16).withTrimmedTop(0).withTrimmedBottom(8);
+    if(bounds.isEmpty()){ return; }
+    
+    float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    
+    KnobKey key { bounds.getWidth(), bounds.getHeight(), juce::roundToInt(scale * 100.0f), slider.isEnabled(),
+                  outlineColor.getARGB(), fillColor.getARGB(), dialColor.getARGB(), rotaryStartAngle, rotaryEndAngle };
+    
+    auto it = knobStrips->strips.find(key);
+    if(it == knobStrips->strips.end()){
+        if(knobStrips->strips.size() >= MAX_KNOB_STRIPS){ knobStrips->strips.clear(); }
+        
+        KnobStrip strip;
+        strip.frameWidth = juce::roundToInt(float(bounds.getWidth()) * scale);
+        strip.frameHeight = juce::roundToInt(float(bounds.getHeight()) * scale);
+        strip.image = juce::Image(juce::Image::ARGB, strip.frameWidth, strip.frameHeight * KNOB_FRAMES, true);
+        it = knobStrips->strips.emplace(key, std::move(strip)).first;
+    }
+    
+    KnobStrip& strip = it->second;
+    int frame = juce::jlimit(0, KNOB_FRAMES - 1, juce::roundToInt(sliderPos * float(KNOB_FRAMES - 1)));
+    int frameY = frame * strip.frameHeight;
+    
+    if(!strip.rendered[size_t(frame)]){
+        juce::Graphics frameGraphics(strip.image);
+        frameGraphics.reduceClipRegion(0, frameY, strip.frameWidth, strip.frameHeight);
+        frameGraphics.addTransform(juce::AffineTransform::scale(scale).translated(0.0f, float(frameY)));
+        
+        auto toAngle = rotaryStartAngle + float(frame) / float(KNOB_FRAMES - 1) * (rotaryEndAngle - rotaryStartAngle);
+        drawKnob(frameGraphics, juce::Rectangle<int>(bounds.getWidth(), bounds.getHeight()).toFloat(), toAngle,
+                 rotaryStartAngle, rotaryEndAngle, key.enabled, outlineColor, fillColor, dialColor);
+        strip.rendered[size_t(frame)] = true;
+    }
+    
+    g.drawImage(strip.image, bounds.getX(), bounds.getY(), bounds.getWidth(), bounds.getHeight(),
+                0, frameY, strip.frameWidth, strip.frameHeight);
+}
+
+void LookAndFeel::drawKnob(juce::Graphics& g, juce::Rectangle<float> bounds, float toAngle, float rotaryStartAngle, float rotaryEndAngle, bool enabled, juce::Colour outlineColor, juce::Colour fillColor, juce::Colour dialColor){
     
     auto radius = bounds.getWidth() / 2.0f;
-    auto toAngle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
     auto lineW = 6.0f;
     auto arcRadius = radius - lineW / 2.0f;
     auto arg = toAngle - juce::MathConstants<float>::halfPi;
@@ -49,7 +85,7 @@ void LookAndFeel::drawRotarySlider(juce::Graphics& g, int x, int y, int width, i
     g.setColour(outlineColor);
     g.strokePath(backgroundArc, strokeType);
     
-    if(slider.isEnabled()){
+    if(enabled){
         juce::Path valueArc;
         valueArc.addCentredArc(center.x, center.y, arcRadius, arcRadius, 0.0f, rotaryStartAngle, toAngle, true);
         g.setColour(fillColor);
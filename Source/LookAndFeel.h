@@ -11,6 +11,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "SharedResources.h"
 
 class LookAndFeel : public juce::LookAndFeel_V4 {
 public:
@@ -18,5 +19,45 @@ public:
     void drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height, float sliderPos, float rotaryStartAngle, float rotaryEndAngle, juce::Slider& slider) override;
     
 private:
+    // Knobs are drawn from pre-rendered image strips, one frame per position.
+    // A strip is keyed on everything that changes its pixels, so a resize or
+    // colour change simply selects (and lazily renders) a different strip.
+    static constexpr int KNOB_FRAMES = 128;
+    static constexpr size_t MAX_KNOB_STRIPS = 16;
+    
+    struct KnobKey
+    {
+        int width, height, scale;
+        bool enabled;
+        juce::uint32 outline, fill, dial;
+        float startAngle, endAngle;
+        
+        bool operator<(const KnobKey& other) const
+        {
+            return std::tie(width, height, scale, enabled, outline, fill, dial, startAngle, endAngle)
+                 < std::tie(other.width, other.height, other.scale, other.enabled, other.outline, other.fill, other.dial, other.startAngle, other.endAngle);
+        }
+    };
+    
+    struct KnobStrip
+    {
+        juce::Image image;
+        int frameWidth = 0;
+        int frameHeight = 0;
+        std::array<bool, KNOB_FRAMES> rendered {};
+    };
+    
+    void drawKnob(juce::Graphics& g, juce::Rectangle<float> bounds, float toAngle, float rotaryStartAngle, float rotaryEndAngle, bool enabled, juce::Colour outlineColor, juce::Colour fillColor, juce::Colour dialColor);
+    
+    // Every editor in the process draws from the same strips. They are only
+    // touched on the message thread, so no locking is needed.
+    struct KnobStripCache
+    {
+        std::map<KnobKey, KnobStrip> strips;
+    };
+    
+    juce::SharedResourcePointer<KnobStripCache> knobStrips;
+    juce::SharedResourcePointer<SharedFonts> fonts;
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LookAndFeel)
 };
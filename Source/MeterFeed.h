@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    MeterFeed.h
+    Created: 19 Oct 2026 11:40:51am
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct MeterFrame
+{
+    float peakLeft;
+    float peakRight;
+    float rmsLeft;
+    float rmsRight;
+};
+
+// Carries output levels and a decimated waveform from the audio thread to the
+// editor. Both directions go through juce::AbstractFifo, which is wait-free
+// for one producer and one consumer: when the editor is closed or falls
+// behind, the audio thread drops data instead of waiting.
+class MeterFeed
+{
+public:
+    static constexpr int SCOPE_DECIMATION = 8;
+
+    void prepare(double sampleRate)
+    {
+        // One meter frame every ~5 ms.
+        frameLength = std::max(1, int(sampleRate * 0.005));
+        ticksToSeconds = 1.0 / double(juce::Time::getHighResolutionTicksPerSecond());
+        inverseSampleRate = 1.0 / sampleRate;
+        reset();
+    }
+
+    void reset()
+    {
+        framePosition = 0;
+        scopePosition = 0;
+        scratchCount = 0;
+        peakLeft = peakRight = 0.0f;
+        sumLeft = sumRight = 0.0f;
+    }
+
+    // Audio thread. right may be nullptr for a mono bus.
+    template <typename SampleType>
+    void push(const SampleType* left, const SampleType* right, int sampleCount)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        if(right == nullptr) { right = left; }
+
+        for(int i = 0; i < sampleCount; ++i){
+            const float l = float(left[i]);
+            const float r = float(right[i]);
+            peakLeft = std::max(peakLeft, std::abs(l));
+            peakRight = std::max(peakRight, std::abs(r));
+            sumLeft += l * l;
+            sumRight += r * r;
+
+            if(++scopePosition >= SCOPE_DECIMATION){
+                scopePosition = 0;
+                scopeScratch[scratchCount++] = 0.5f * (l + r);
+                if(scratchCount == SCRATCH_SIZE) { flushScope(); }
+            }
+
+            if(++framePosition >= frameLength){
+                const float scale = 1.0f / float(frameLength);
+                const MeterFrame frame { peakLeft, peakRight, std::sqrt(sumLeft * scale), std::sqrt(sumRight * scale) };
+                frameFifo.write(1).forEach([&](int index) { frames[size_t(index)] = frame; });
+                framePosition = 0;
+                peakLeft = peakRight = 0.0f;
+                sumLeft = sumRight = 0.0f;
+            }
+        }
+
+        flushScope();
+
+        // Fraction of the block's real-time duration spent in here.
+        const double elapsed = double(juce::Time::getHighResolutionTicks() - start) * ticksToSeconds;
+        const double blockDuration = double(sampleCount) * inverseSampleRate;
+        if(blockDuration > 0.0){
+            const float load = float(elapsed / blockDuration);
+            audioThreadLoad.store(0.99f * audioThreadLoad.load(std::memory_order_relaxed) + 0.01f * load,
+                                  std::memory_order_relaxed);
+        }
+    }
+
+    // Message thread. Returns the number of frames copied.
+    int pullFrames(MeterFrame* dest, int maxFrames)
+    {
+        int count = 0;
+        frameFifo.read(std::min(maxFrames, frameFifo.getNumReady()))
+            .forEach([&](int index) { dest[count++] = frames[size_t(index)]; });
+        return count;
+    }
+
+    // Message thread. Returns the number of scope samples copied.
+    int pullScope(float* dest, int maxSamples)
+    {
+        int count = 0;
+        scopeFifo.read(std::min(maxSamples, scopeFifo.getNumReady()))
+            .forEach([&](int index) { dest[count++] = scope[size_t(index)]; });
+        return count;
+    }
+
+    // Smoothed share of real time the audio thread spends pushing.
+    float getAudioThreadLoad() const
+    {
+        return audioThreadLoad.load(std::memory_order_relaxed);
+    }
+
+private:
+    void flushScope()
+    {
+        int count = 0;
+        scopeFifo.write(scratchCount).forEach([&](int index) { scope[size_t(index)] = scopeScratch[count++]; });
+        scratchCount = 0;
+    }
+
+    static constexpr int FRAME_CAPACITY = 256;
+    static constexpr int SCOPE_CAPACITY = 8192;
+
+    juce::AbstractFifo frameFifo { FRAME_CAPACITY };
+    std::array<MeterFrame, FRAME_CAPACITY> frames {};
+    juce::AbstractFifo scopeFifo { SCOPE_CAPACITY };
+    std::array<float, SCOPE_CAPACITY> scope {};
+
+    static constexpr int SCRATCH_SIZE = 64;
+    float scopeScratch[SCRATCH_SIZE];
+    int scratchCount = 0;
+
+    int frameLength = 220;
+    int framePosition = 0;
+    int scopePosition = 0;
+    float peakLeft = 0.0f, peakRight = 0.0f;
+    float sumLeft = 0.0f, sumRight = 0.0f;
+
+    double ticksToSeconds = 0.0;
+    double inverseSampleRate = 1.0 / 44100.0;
+    std::atomic<float> audioThreadLoad { 0.0f };
+};
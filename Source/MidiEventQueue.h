@@ -0,0 +1,275 @@
+/*
+  ==============================================================================
+
+    MidiEventQueue.h
+    Created: 19 Oct 2026 4:12:38pm
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// A MIDI message decoded for the engine, and where in the block it happens.
+struct SynthEvent
+{
+    enum class Type : uint8_t { noteOn, noteOff, controlChange, pitchBend, pressure };
+
+    int sampleOffset;
+    Type type;
+    uint8_t channel;
+    uint8_t number;    // note or controller number
+    uint16_t value;    // velocity, controller value, or 14-bit bend with 8192 in the middle
+};
+
+// Turns a short MIDI message into an engine event. Returns false for
+// messages the engine has no use for.
+inline bool decodeMidiEvent(int sampleOffset, uint8_t data0, uint8_t data1, uint8_t data2, SynthEvent& event)
+{
+    event.sampleOffset = sampleOffset;
+    event.channel = data0 & 0x0F;
+    event.number = data1 & 0x7F;
+    event.value = data2 & 0x7F;
+
+    switch(data0 & 0xF0){
+        case 0x80:
+            event.type = SynthEvent::Type::noteOff;
+            return true;
+        case 0x90:
+            event.type = (event.value > 0) ? SynthEvent::Type::noteOn : SynthEvent::Type::noteOff;
+            return true;
+        case 0xB0:
+            event.type = SynthEvent::Type::controlChange;
+            return true;
+        case 0xD0:
+            event.type = SynthEvent::Type::pressure;
+            event.number = 0;
+            event.value = data1 & 0x7F;
+            return true;
+        case 0xE0:
+            event.type = SynthEvent::Type::pitchBend;
+            event.number = 0;
+            event.value = uint16_t((data1 & 0x7F) + 128 * (data2 & 0x7F));
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Counts what the queue did with the incoming MIDI. Updated on the audio
+// thread once per block, read by the editor (see EngineStatus).
+struct MidiEventStats
+{
+    std::atomic<uint32_t> received { 0 };
+    std::atomic<uint32_t> ignored { 0 };     // no meaning for the engine
+    std::atomic<uint32_t> coalesced { 0 };   // replaced by a newer value
+    std::atomic<uint32_t> redundant { 0 };   // repeated the value already in effect
+};
+
+// The engine events for one block. Messages are decoded once when they are
+// added; before rendering, coalesce() thins out streams of controller data:
+//
+//  - A pitch bend, pressure or controller value that is followed within one
+//    control period by another value for the same engine setting is
+//    dropped. The engine only reacts at control rate anyway, and the stream
+//    still gets at least one value per period.
+//  - A value equal to the one already in effect is dropped, and so are
+//    controllers the engine doesn't respond to.
+//
+// Note events are never touched, and a controller stream never merges
+// across a note, so every note starts with exactly the values that were
+// sent before it. The sustain pedal and the channel mode messages are
+// commands rather than values and are always kept.
+class MidiEventQueue
+{
+public:
+    static constexpr size_t CAPACITY = 1024;
+
+    MidiEventQueue()
+    {
+        // The capacity is fixed, so the audio thread never allocates.
+        events.reserve(CAPACITY);
+        invalidate();
+    }
+
+    void add(int sampleOffset, uint8_t data0, uint8_t data1, uint8_t data2)
+    {
+        ++blockCounts.received;
+
+        SynthEvent event;
+        if(decodeMidiEvent(sampleOffset, data0, data1, data2, event)){
+            events.push_back(event);
+        }else{
+            ++blockCounts.ignored;
+        }
+    }
+
+    bool isFull() const { return events.size() == CAPACITY; }
+    void clear() { events.clear(); }
+    const SynthEvent* data() const { return events.data(); }
+    int size() const { return int(events.size()); }
+
+    // The engine settings that decide which state a message writes to (see
+    // Synth::handleEvent). Changing them starts over.
+    void setMapping(bool newMpe, bool newMultiTimbral, uint8_t newResoCC)
+    {
+        if(newMpe != mpe || newMultiTimbral != multiTimbral || newResoCC != resoCC){
+            mpe = newMpe;
+            multiTimbral = newMultiTimbral;
+            resoCC = newResoCC;
+            invalidate();
+        }
+    }
+
+    // Forget the values in effect, after the engine was reset.
+    void invalidate()
+    {
+        lastValue.fill(UNKNOWN);
+    }
+
+    void coalesce(int controlPeriod)
+    {
+        // Pending entries from earlier blocks or before the last note are
+        // told apart by their generation, so nothing needs to be cleared.
+        ++generation;
+
+        for(size_t i = 0; i < events.size(); ++i){
+            SynthEvent& event = events[i];
+            int slot = getSlot(event);
+            if(slot == NOTE){
+                ++generation;
+            }
+            if(slot < 0){ continue; }
+
+            Pending& entry = pending[size_t(slot)];
+            if(entry.generation == generation && event.sampleOffset - entry.windowStart < controlPeriod){
+                events[size_t(entry.index)].type = REMOVED;
+                ++blockCounts.coalesced;
+            }else{
+                entry.generation = generation;
+                entry.windowStart = event.sampleOffset;
+            }
+            entry.index = int(i);
+        }
+
+        // Compact what is left, dropping values that change nothing.
+        size_t count = 0;
+        for(size_t i = 0; i < events.size(); ++i){
+            const SynthEvent& event = events[i];
+            if(event.type == REMOVED){ continue; }
+
+            int slot = getSlot(event);
+            if(slot == UNUSED){
+                ++blockCounts.ignored;
+                continue;
+            }
+            if(slot >= 0){
+                // Two controllers share the filter slot, so the number is
+                // part of the value.
+                uint16_t value = (event.type == SynthEvent::Type::controlChange)
+                               ? uint16_t(event.number << 7 | event.value) : event.value;
+                if(lastValue[size_t(slot)] == value){
+                    ++blockCounts.redundant;
+                    continue;
+                }
+                lastValue[size_t(slot)] = value;
+            }
+            events[count++] = event;
+        }
+        events.resize(count);
+
+        // The per-event counting stays in plain integers; the shared
+        // counters are only touched here, once per block.
+        publishCounts();
+    }
+
+    MidiEventStats stats;
+
+private:
+    void publishCounts()
+    {
+        auto publish = [](std::atomic<uint32_t>& counter, uint32_t& count){
+            if(count != 0){
+                counter.fetch_add(count, std::memory_order_relaxed);
+                count = 0;
+            }
+        };
+        publish(stats.received, blockCounts.received);
+        publish(stats.ignored, blockCounts.ignored);
+        publish(stats.coalesced, blockCounts.coalesced);
+        publish(stats.redundant, blockCounts.redundant);
+    }
+
+    static constexpr SynthEvent::Type REMOVED = SynthEvent::Type(0xFF);
+    static constexpr uint16_t UNKNOWN = 0xFFFF;
+
+    // Not a value: notes, commands, and controllers the engine ignores.
+    static constexpr int NOTE = -1;
+    static constexpr int COMMAND = -2;
+    static constexpr int UNUSED = -3;
+
+    // One slot for every piece of engine state a value message can write.
+    // Bend and pressure use slot 0 of their range for the whole instrument,
+    // and one slot per MPE member channel or multi-timbral part.
+    static constexpr int FILTER_SLOT = 0;
+    static constexpr int RESONANCE_SLOT = 1;
+    static constexpr int SLIDE_SLOTS = 2;
+    static constexpr int BEND_SLOTS = SLIDE_SLOTS + 16;
+    static constexpr int PRESSURE_SLOTS = BEND_SLOTS + 16;
+    static constexpr int NUM_SLOTS = PRESSURE_SLOTS + 16;
+
+    int getSlot(const SynthEvent& event) const
+    {
+        const bool memberChannel = (mpe && event.channel > 0) || multiTimbral;
+
+        switch(event.type){
+            case SynthEvent::Type::pitchBend:
+                return BEND_SLOTS + (memberChannel ? event.channel : 0);
+            case SynthEvent::Type::pressure:
+                return PRESSURE_SLOTS + (memberChannel ? event.channel : 0);
+            case SynthEvent::Type::controlChange: {
+                const uint8_t number = event.number;
+                if(number == 0x40 || number >= 0x78){ return COMMAND; }
+                if(number == 0x4A && mpe && event.channel > 0){ return SLIDE_SLOTS + event.channel; }
+
+                const bool filter = number == 0x4A || number == 0x4B;
+                const bool resonance = number == resoCC;
+                if(filter && resonance){ return COMMAND; }   // writes both, keep it simple
+                if(filter){ return FILTER_SLOT; }
+                if(resonance){ return RESONANCE_SLOT; }
+                return UNUSED;
+            }
+            default:
+                return NOTE;
+        }
+    }
+
+    struct Pending
+    {
+        uint32_t generation = 0;
+        int windowStart = 0;
+        int index = 0;
+    };
+
+    struct Counts
+    {
+        uint32_t received = 0;
+        uint32_t ignored = 0;
+        uint32_t coalesced = 0;
+        uint32_t redundant = 0;
+    };
+
+    std::vector<SynthEvent> events;
+    Counts blockCounts;
+    std::array<Pending, NUM_SLOTS> pending {};
+    std::array<uint16_t, NUM_SLOTS> lastValue;
+    uint32_t generation = 0;
+    bool mpe = false;
+    bool multiTimbral = false;
+    uint8_t resoCC = 0x47;
+};
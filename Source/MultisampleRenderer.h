@@ -0,0 +1,195 @@
+/*
+  ==============================================================================
+
+    MultisampleRenderer.h
+    Created: 19 Oct 2026 7:02:44pm
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "OfflineRenderer.h"
+
+// A preset to sample, with its engine settings already built for the
+// sample rate of the library (see JX11AudioProcessor::getPresetSnapshots).
+struct MultisamplePreset
+{
+    juce::String name;
+    SynthParams params;
+};
+
+struct MultisampleSettings
+{
+    std::vector<int> notes { 36, 48, 60, 72, 84 };
+    std::vector<int> velocities { 40, 80, 127 };   // one per layer
+
+    double sampleRate = 48000.0;
+    int numChannels = 2;
+    int bitsPerSample = 24;
+
+    double holdSeconds = 2.0;          // note-on to note-off
+    double maxReleaseSeconds = 4.0;    // longest tail kept after the note-off
+    float tailThreshold = 0.0001f;     // -80 dB, the tail is cut after the last louder sample
+
+    int numThreads = 0;                // 0 = one per core
+};
+
+// Samples presets into a multisample library: every preset is played at
+// every note and velocity layer, each note written to its own WAV file, and
+// one SFZ file per preset maps the samples onto key and velocity ranges.
+//
+// Every job renders on its own engine in a thread pool. The engines start
+// from a reset and share nothing but read-only tables, so each file comes
+// out the same whatever the number of threads or the order the jobs finish
+// in. The SFZ files are written after all jobs are done, in preset order.
+class MultisampleRenderer
+{
+public:
+    // Returns false if the folder can't be created or any file can't be
+    // written; the jobs that did succeed keep their files.
+    static bool render(const std::vector<MultisamplePreset>& presets, const MultisampleSettings& settings,
+                       const juce::File& folder)
+    {
+        if(!folder.createDirectory()){ return false; }
+
+        std::vector<int> notes = settings.notes;
+        std::vector<int> velocities = settings.velocities;
+        auto outOfRange = [](int value){ return value < 0 || value > 127; };
+        notes.erase(std::remove_if(notes.begin(), notes.end(), outOfRange), notes.end());
+        velocities.erase(std::remove_if(velocities.begin(), velocities.end(),
+                                        [](int value){ return value < 1 || value > 127; }), velocities.end());
+        std::sort(notes.begin(), notes.end());
+        std::sort(velocities.begin(), velocities.end());
+        notes.erase(std::unique(notes.begin(), notes.end()), notes.end());
+        velocities.erase(std::unique(velocities.begin(), velocities.end()), velocities.end());
+
+        const int jobsPerPreset = int(notes.size() * velocities.size());
+        const int numJobs = int(presets.size()) * jobsPerPreset;
+        if(numJobs == 0){ return true; }
+
+        std::vector<Sample> samples(size_t(numJobs));
+        std::atomic<int> remaining { numJobs };
+        std::atomic<bool> failed { false };
+        juce::WaitableEvent done;
+
+        const int numThreads = (settings.numThreads > 0) ? settings.numThreads : juce::SystemStats::getNumCpus();
+        juce::ThreadPool pool(std::min(numThreads, numJobs));
+
+        for(int job = 0; job < numJobs; ++job){
+            const int p = job / jobsPerPreset;
+            Sample& sample = samples[size_t(job)];
+            sample.note = notes[size_t((job % jobsPerPreset) / int(velocities.size()))];
+            sample.velocity = velocities[size_t(job % int(velocities.size()))];
+            sample.file = folder.getChildFile(getSampleName(p, presets[size_t(p)].name, sample.note, sample.velocity));
+
+            pool.addJob([&, p, job]{
+                if(!renderSample(presets[size_t(p)].params, settings, samples[size_t(job)])){
+                    failed = true;
+                }
+                if(--remaining == 0){
+                    done.signal();
+                }
+            });
+        }
+        done.wait();
+
+        for(int p = 0; p < int(presets.size()); ++p){
+            const Sample* first = samples.data() + p * jobsPerPreset;
+            juce::File sfz = folder.getChildFile(getPresetName(p, presets[size_t(p)].name) + ".sfz");
+            if(!sfz.replaceWithText(makeSfz(first, notes, velocities))){
+                failed = true;
+            }
+        }
+        return !failed;
+    }
+
+private:
+    struct Sample
+    {
+        int note = 0;
+        int velocity = 0;
+        juce::File file;
+    };
+
+    // No spaces, so the names can go into the SFZ file as they are.
+    static juce::String getPresetName(int index, const juce::String& name)
+    {
+        juce::String legalName = juce::File::createLegalFileName(name).replaceCharacter(' ', '_');
+        return juce::String(index + 1).paddedLeft('0', 3) + "_" + legalName;
+    }
+
+    static juce::String getSampleName(int index, const juce::String& name, int note, int velocity)
+    {
+        return getPresetName(index, name) + "_n" + juce::String(note).paddedLeft('0', 3)
+             + "_v" + juce::String(velocity).paddedLeft('0', 3) + ".wav";
+    }
+
+    static bool renderSample(const SynthParams& params, const MultisampleSettings& settings, const Sample& sample)
+    {
+        const int holdSamples = std::max(1, int(settings.holdSeconds * settings.sampleRate));
+        const int totalSamples = holdSamples + int(settings.maxReleaseSeconds * settings.sampleRate);
+
+        juce::MidiBuffer midi;
+        midi.addEvent(juce::MidiMessage::noteOn(1, sample.note, juce::uint8(sample.velocity)), 0);
+        midi.addEvent(juce::MidiMessage::noteOff(1, sample.note), holdSamples);
+
+        juce::AudioBuffer<float> buffer(settings.numChannels, totalSamples);
+        OfflineRenderer<float> renderer(params, settings.sampleRate);
+        renderer.render(midi, buffer);
+
+        // Cut the tail after the last sample above the threshold.
+        int length = holdSamples;
+        for(int ch = 0; ch < buffer.getNumChannels(); ++ch){
+            const float* data = buffer.getReadPointer(ch);
+            for(int i = totalSamples - 1; i >= length; --i){
+                if(std::abs(data[i]) > settings.tailThreshold){
+                    length = i + 1;
+                    break;
+                }
+            }
+        }
+
+        sample.file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream = sample.file.createOutputStream();
+        if(stream == nullptr){ return false; }
+
+        juce::WavAudioFormat format;
+        std::unique_ptr<juce::AudioFormatWriter> writer(format.createWriterFor(stream.get(), settings.sampleRate,
+                                                                               unsigned(settings.numChannels),
+                                                                               settings.bitsPerSample, {}, 0));
+        if(writer == nullptr){ return false; }
+        stream.release();   // the writer owns it now
+
+        return writer->writeFromAudioSampleBuffer(buffer, 0, length);
+    }
+
+    // Each sampled note covers the keys up to halfway to its neighbours, and
+    // each velocity layer the velocities above the layer below it.
+    static juce::String makeSfz(const Sample* samples, const std::vector<int>& notes, const std::vector<int>& velocities)
+    {
+        juce::String text;
+        text << "// Generated by " << JucePlugin_Name << "\n\n";
+
+        const int numNotes = int(notes.size());
+        const int numLayers = int(velocities.size());
+        for(int n = 0; n < numNotes; ++n){
+            const int lokey = (n == 0) ? 0 : (notes[size_t(n - 1)] + notes[size_t(n)]) / 2 + 1;
+            const int hikey = (n == numNotes - 1) ? 127 : (notes[size_t(n)] + notes[size_t(n + 1)]) / 2;
+
+            for(int l = 0; l < numLayers; ++l){
+                const int lovel = (l == 0) ? 1 : velocities[size_t(l - 1)] + 1;
+                const int hivel = (l == numLayers - 1) ? 127 : velocities[size_t(l)];
+                const Sample& sample = samples[n * numLayers + l];
+
+                text << "<region> sample=" << sample.file.getFileName()
+                     << " pitch_keycenter=" << sample.note
+                     << " lokey=" << lokey << " hikey=" << hikey
+                     << " lovel=" << lovel << " hivel=" << hivel << "\n";
+            }
+        }
+        return text;
+    }
+};
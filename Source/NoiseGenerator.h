@@ -10,26 +10,101 @@
 
 #pragma once
 
+#include <JuceHeader.h>
+
 class NoiseGenerator
 {
 public:
-    void reset()
+    // Every stream starts from the same fixed seed, so renders are
+    // deterministic. Stream n is the same sequence jumped ahead by n * 2^28
+    // steps, which keeps the streams of different voices from overlapping
+    // for well over an hour of audio.
+    void reset(int stream = 0)
     {
         noiseSeed = 22222;
+        
+        unsigned int a, c;
+        jump(1u << 28, a, c);
+        for(int i = 0; i < stream; ++i){
+            noiseSeed = noiseSeed * a + c;
+        }
     }
     
     float nextValue()
     {
         // Generate the next integer pseudorandom number.
-        noiseSeed = noiseSeed * 196314165 + 907633515;
+        noiseSeed = noiseSeed * MULTIPLIER + INCREMENT;
+        
+        return toFloat(noiseSeed);
+    }
+    
+    // Produces exactly the same values as calling nextValue() sampleCount
+    // times. The sequence is split into LANES interleaved lanes that each
+    // advance LANES steps at a time, so the inner loop has no dependency
+    // between lanes and vectorizes.
+    // Forced inline so the CPU-specific kernels in DspKernels.cpp get their
+    // own copy compiled for their instruction set.
+    template <typename SampleType>
+    forcedinline void fill(SampleType* dest, int sampleCount)
+    {
+        int i = 0;
         
+        if(sampleCount >= LANES){
+            unsigned int a, c;
+            jump(LANES, a, c);
+            
+            unsigned int lanes[LANES];
+            unsigned int x = noiseSeed;
+            for(int j = 0; j < LANES; ++j){
+                x = x * MULTIPLIER + INCREMENT;
+                lanes[j] = x;
+            }
+            
+            for(; i + LANES <= sampleCount; i += LANES){
+                noiseSeed = lanes[LANES - 1];
+                for(int j = 0; j < LANES; ++j){
+                    dest[i + j] = SampleType(toFloat(lanes[j]));
+                    lanes[j] = lanes[j] * a + c;
+                }
+            }
+        }
+        
+        for(; i < sampleCount; ++i){
+            dest[i] = SampleType(nextValue());
+        }
+    }
+    
+private:
+    static constexpr int LANES = 8;
+    static constexpr unsigned int MULTIPLIER = 196314165;
+    static constexpr unsigned int INCREMENT = 907633515;
+    
+    static float toFloat(unsigned int seed)
+    {
         // Convert to a signed value.
-        int temp = int(noiseSeed >> 7) - 16777216;
+        int temp = int(seed >> 7) - 16777216;
         
         // Convert to a floating-point number between -1.0 and 1.0
         return float(temp)/16777216.0f;
     }
     
-private:
+    // Multiplier and increment that advance the generator by `steps` at once.
+    static void jump(unsigned int steps, unsigned int& a, unsigned int& c)
+    {
+        unsigned int stepA = MULTIPLIER;
+        unsigned int stepC = INCREMENT;
+        a = 1;
+        c = 0;
+        while(steps > 0){
+            if(steps & 1){
+                a = a * stepA;
+                c = c * stepA + stepC;
+            }
+            stepC = stepC * stepA + stepC;
+            stepA = stepA * stepA;
+            steps >>= 1;
+        }
+    }
+    
     unsigned int noiseSeed;
 };
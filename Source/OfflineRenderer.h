@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 19 Oct 2026 2:31:06pm
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Synth.h"
+
+// Renders a MIDI sequence through its own engine, without a host or an audio
+// device. Use SampleType = double for reference renders to compare the float
+// engine against.
+template <typename SampleType>
+class OfflineRenderer
+{
+public:
+    OfflineRenderer(const SynthParams& params, double sampleRate, int blockSize = 512)
+        : blockSize(std::max(blockSize, 1))
+    {
+        synth.allocateResources(sampleRate, this->blockSize);
+        synth.setParams(params);
+        synth.reset();
+        synth.outputLevelSmoother.setCurrentAndTargetValue(SampleType(params.outputLevel));
+    }
+
+    // Without FTZ/DAZ the engine relies on its own flushing; for benchmarks.
+    void setFlushDenormals(bool shouldFlush)
+    {
+        synth.flushDenormals = shouldFlush;
+    }
+
+    // Renders through the loop that tests the output and noise settings per
+    // sample rather than the kernel compiled for them; for benchmarks.
+    void setSpecializeRender(bool shouldSpecialize)
+    {
+        synth.specializeRender = shouldSpecialize;
+    }
+
+    // Fills the whole buffer (one or two channels). Events past the end of
+    // the buffer are ignored. As in a host, the audio lags the events by
+    // Synth::LATENCY_SAMPLES. Each call carries on from where the previous
+    // one stopped.
+    void render(const juce::MidiBuffer& midiMessages, juce::AudioBuffer<SampleType>& output)
+    {
+        output.clear();
+        const int sampleCount = output.getNumSamples();
+        SampleType* left = output.getWritePointer(0);
+        SampleType* right = (output.getNumChannels() > 1) ? output.getWritePointer(1) : nullptr;
+
+        // Same block sizes as a host would use, each one rendered in a single
+        // call with its events. Nothing is coalesced, so reference renders
+        // see every event.
+        auto event = midiMessages.cbegin();
+        for(int position = 0; position < sampleCount; position += blockSize){
+            const int count = std::min(blockSize, sampleCount - position);
+
+            events.clear();
+            for(; event != midiMessages.cend() && (*event).samplePosition < position + count; ++event){
+                const auto metadata = *event;
+                SynthEvent decoded;
+                if(metadata.numBytes <= 3){
+                    uint8_t data1 = (metadata.numBytes >= 2) ? metadata.data[1] : 0;
+                    uint8_t data2 = (metadata.numBytes == 3) ? metadata.data[2] : 0;
+                    if(decodeMidiEvent(std::max(metadata.samplePosition - position, 0), metadata.data[0], data1, data2, decoded)){
+                        events.push_back(decoded);
+                    }
+                }
+            }
+
+            SampleType* outputBuffers[2] = { left + position, (right != nullptr) ? right + position : nullptr };
+            synth.render(outputBuffers, count, events.data(), int(events.size()));
+        }
+    }
+
+private:
+    Synth<SampleType> synth;
+    std::vector<SynthEvent> events;
+    int blockSize;
+};
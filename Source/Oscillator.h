@@ -16,41 +16,42 @@ const float PI_OVER_4 = 0.7853981633974483f;
 const float PI = 3.1415926535897932f;
 const float TWO_PI = 6.2831853071795864f;
 
+template <typename SampleType>
 class Oscillator
 {
 public:
-    float period = 0.0f;
-    float amplitude = 1.0f;
-    float modulation = 1.0f;
+    SampleType period = 0;
+    SampleType amplitude = 1;
+    SampleType modulation = 1;
     
     void reset()
     {
-        inc = 0.0f;
-        phase = 0.0f;
-        sin0 = 0.0f;
-        sin1 = 0.0f;
-        dsin = 0.0f;
-        dc = 0.0f;
+        inc = 0;
+        phase = 0;
+        sin0 = 0;
+        sin1 = 0;
+        dsin = 0;
+        dc = 0;
     }
     
-    float nextSample()
+    SampleType nextSample()
     {
-        float output = 0.0f;
+        SampleType output = 0;
         
         phase += inc;
         
-        if(phase <= PI_OVER_4){
-            float halfPeriod = (period / 2.0f) * modulation;
-            phaseMax = std::floor(0.5f + halfPeriod) - 0.5f;
-            dc = 0.5f * amplitude / phaseMax;
-            phaseMax *= PI;
+        if(phase <= SampleType(PI_OVER_4)){
+            SampleType halfPeriod = (period / SampleType(2)) * modulation;
+            phaseMax = std::floor(SampleType(0.5) + halfPeriod) - SampleType(0.5);
+            dc = SampleType(0.5) * amplitude / phaseMax;
+            phaseMax *= SampleType(PI);
             
             inc = phaseMax / halfPeriod;
             phase = -phase;
             
             sin0 = amplitude * std::sin(phase);
             sin1 = amplitude * std::sin(phase - inc);
-            dsin = 2.0f * std::cos(inc);
+            dsin = SampleType(2) * std::cos(inc);
             
             if(phase*phase > 1e-9){
                 output = sin0 / phase;
@@ -62,7 +63,7 @@ public:
                 phase = phaseMax + phaseMax - phase;
                 inc = -inc;
             }
-            float sinp = dsin * sin0 - sin1;
+            SampleType sinp = dsin * sin0 - sin1;
             sin1 = sin0;
             sin0 = sinp;
             output = sinp / phase;
@@ -71,31 +72,31 @@ public:
         return output - dc;
     }
     
-    void squareWave(Oscillator& other, float newPeriod)
+    void squareWave(Oscillator& other, SampleType newPeriod)
     {
         reset();
         
-        if(other.inc > 0.0f) {
+        if(other.inc > 0) {
             phase = other.phaseMax + other.phaseMax - other.phase;
             inc = -other.inc;
-        }else if (other.inc < 0.0f) {
+        }else if (other.inc < 0) {
             phase = other.phase;
             inc = other.inc;
         }else {
-            phase = -PI;
-            inc = PI;
+            phase = -SampleType(PI);
+            inc = SampleType(PI);
         }
         
-        phase += PI * newPeriod / 2.0f;
+        phase += SampleType(PI) * newPeriod / SampleType(2);
         phaseMax = phase;
     }
     
 private:
-    float phase;
-    float phaseMax;
-    float inc;
-    float sin0;
-    float sin1;
-    float dsin;
-    float dc;
+    SampleType phase;
+    SampleType phaseMax;
+    SampleType inc;
+    SampleType sin0;
+    SampleType sin1;
+    SampleType dsin;
+    SampleType dc;
 };
@@ -9,6 +9,10 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+// Keep in sync with EDITOR_WIDTH / EDITOR_HEIGHT in Scripts/build_assets.py.
+static constexpr int editorWidth = 806;
+static constexpr int editorHeight = 460;
+
 //==============================================================================
 JX11AudioProcessorEditor::JX11AudioProcessorEditor (JX11AudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
@@ -46,21 +50,20 @@ JX11AudioProcessorEditor::JX11AudioProcessorEditor (JX11AudioProcessor& p)
     outputFader.setRange(-24.0, 3.0, 0.1);
     addAndMakeVisible(outputFader);
     
+    addAndMakeVisible(levelMeter);
+    addAndMakeVisible(engineStatus);
+    
+    tuningButton.setButtonText("Tuning");
+    tuningButton.onClick = [this] { showTuningMenu(); };
+    addAndMakeVisible(tuningButton);
+    
     juce::LookAndFeel::setDefaultLookAndFeel(&globalLNF);
     
     //midiLearnButton.setButtonText("MIDI Learn");
     //midiLearnButton.addListener(this);
     //addAndMakeVisible(midiLearnButton);
     
-    auto imageFull = juce::ImageCache::getFromMemory(BinaryData::CloseupFrontviewWhitefacadeofdirtyindustrialmetalTheentirecenteriswhite_jpg, BinaryData::CloseupFrontviewWhitefacadeofdirtyindustrialmetalTheentirecenteriswhite_jpgSize);
-    
-    auto imageScaled = imageFull.rescaled(imageFull.getWidth()*(0.3), imageFull.getHeight()*(0.3));
-    DBG(imageFull.getWidth());
-    DBG(imageFull.getHeight());
-    DBG(imageScaled.getWidth());
-    DBG(imageScaled.getHeight());
-    
-    setSize (imageScaled.getWidth(),imageScaled.getHeight());
+    setSize (editorWidth, editorHeight);
 }
 
 JX11AudioProcessorEditor::~JX11AudioProcessorEditor()
@@ -74,16 +77,17 @@ void JX11AudioProcessorEditor::paint (juce::Graphics& g)
 {
     //g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
     //auto image = juce::ImageCache::getFromMemory(BinaryData::Logo_png, BinaryData::Logo_pngSize);
-    auto imageFull = juce::ImageCache::getFromMemory(BinaryData::CloseupFrontviewWhitefacadeofdirtyindustrialmetalTheentirecenteriswhite_jpg, BinaryData::CloseupFrontviewWhitefacadeofdirtyindustrialmetalTheentirecenteriswhite_jpgSize);
-    
-    auto imageScaled = imageFull.rescaled(imageFull.getWidth()*(0.3), imageFull.getHeight()*0.3);
     
-    DBG(imageFull.getWidth());
-    DBG(imageFull.getHeight());
-    DBG(imageScaled.getWidth());
-    DBG(imageScaled.getHeight());
+    // The background is embedded pre-scaled to the editor size (see
+    // Scripts/build_assets.py) and only decoded the first time it is drawn.
+    bool hiDpi = g.getInternalContext().getPhysicalPixelScaleFactor() > 1.0f;
+    juce::Image& background = hiDpi ? background2x : background1x;
+    if(!background.isValid()){
+        background = hiDpi ? juce::ImageCache::getFromMemory(BinaryData::background_2x_jpg, BinaryData::background_2x_jpgSize)
+                           : juce::ImageCache::getFromMemory(BinaryData::background_1x_jpg, BinaryData::background_1x_jpgSize);
+    }
     
-    g.drawImage(imageScaled, 0, 0, imageScaled.getWidth(), imageScaled.getHeight(), 0, 0, imageScaled.getWidth(), imageScaled.getHeight());
+    g.drawImage(background, getLocalBounds().toFloat());
 }
 
 void JX11AudioProcessorEditor::resized()
@@ -116,9 +120,38 @@ void JX11AudioProcessorEditor::resized()
     pitchModeButton.setSize(80, 30);
     pitchModeButton.setCentrePosition(rStyleKnob.getCentreX(), rStyleKnob.getCentreY() - 100);
     
+    levelMeter.setBounds(rTypeKnob.getX(), rTypeKnob.getBottom() + 20, rStyleKnob.getRight() - rTypeKnob.getX(), 70);
+    engineStatus.setBounds(levelMeter.getBounds().withY(levelMeter.getBottom() + 10).withHeight(75));
+    
+    tuningButton.setSize(80, 30);
+    tuningButton.setCentrePosition(rOutputFader.getCentreX(), rOutputFader.getCentreY() - 100);
+    
     //midiLearnButton.setBounds(400, 20, 100, 30);
 }
 
+void JX11AudioProcessorEditor::showTuningMenu()
+{
+    juce::PopupMenu menu;
+    menu.addItem("Load Scala Files...", [this] {
+        tuningChooser = std::make_unique<juce::FileChooser>("Choose a .scl file and optionally a .kbm file", juce::File(), "*.scl;*.kbm");
+        auto flags = juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles | juce::FileBrowserComponent::canSelectMultipleItems;
+        tuningChooser->launchAsync(flags, [this](const juce::FileChooser& chooser) {
+            juce::String scl, kbm;
+            for(const auto& file : chooser.getResults()){
+                if(file.hasFileExtension("kbm")){ kbm = file.loadFileAsString(); }
+                else { scl = file.loadFileAsString(); }
+            }
+            if(scl.isNotEmpty() || kbm.isNotEmpty()){
+                if(!audioProcessor.loadTuning(scl, kbm)){
+                    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Tuning", "The Scala files could not be read.");
+                }
+            }
+        });
+    });
+    menu.addItem("Reset to 12-TET", [this] { audioProcessor.loadTuning({}, {}); });
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(tuningButton));
+}
+
 void JX11AudioProcessorEditor::buttonClicked(juce::Button* button)
 {
     DBG("button clicked");
@@ -12,6 +12,8 @@
 #include "PluginProcessor.h"
 #include "RotaryKnob.h"
 #include "LookAndFeel.h"
+#include "LevelMeter.h"
+#include "EngineStatus.h"
 
 //==============================================================================
 /**
@@ -57,8 +59,18 @@ private:
     
     LookAndFeel globalLNF;
     
+    LevelMeter levelMeter { audioProcessor.meterFeed };
+    EngineStatus engineStatus { audioProcessor };
+    
     juce::TextButton midiLearnButton;
     
+    juce::TextButton tuningButton;
+    std::unique_ptr<juce::FileChooser> tuningChooser;
+    void showTuningMenu();
+    
+    juce::Image background1x;
+    juce::Image background2x;
+    
     void timerCallback() override;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (JX11AudioProcessorEditor)
@@ -13,6 +13,10 @@
 static const juce::Identifier pluginTag = "PLUGIN";
 static const juce::Identifier extraTag = "EXTRA";
 static const juce::Identifier midiCCAttribute = "midiCC";
+static const juce::Identifier sclAttribute = "scl";
+static const juce::Identifier kbmAttribute = "kbm";
+static const juce::Identifier partsTag = "PARTS";
+static const juce::Identifier partTag = "PART";
 
 //==============================================================================
 JX11AudioProcessor::JX11AudioProcessor()
@@ -59,15 +63,35 @@ JX11AudioProcessor::JX11AudioProcessor()
     castParameter(apvts, ParameterID::tuning, tuningParam);
     castParameter(apvts, ParameterID::outputLevel, outputLevelParam);
     castParameter(apvts, ParameterID::polyMode, polyModeParam);
-    
-    createPrograms();
-    setCurrentProgram(0);
+    castParameter(apvts, ParameterID::quality, qualityParam);
+    castParameter(apvts, ParameterID::limiter, limiterParam);
+    castParameter(apvts, ParameterID::noiseMode, noiseModeParam);
+    castParameter(apvts, ParameterID::mpe, mpeParam);
+    castParameter(apvts, ParameterID::multi, multiParam);
+    castParameter(apvts, ParameterID::ensemble, ensembleParam);
+    castParameter(apvts, ParameterID::reverbMix, reverbMixParam);
+    castParameter(apvts, ParameterID::reverbDecay, reverbDecayParam);
+    castParameter(apvts, ParameterID::voiceFloor, voiceFloorParam);
+    
+    voiceUsage = std::make_unique<VoiceUsage[]>(presetBank->presets.size());
+    
+    // No need to reset the synth here, prepareToPlay does that before the
+    // first block, and there is no host yet to tell about the changes.
+    currentProgram = 0;
+    applyPreset(presetBank->presets[0]);
+    
+    parts.fill(getCurrentPart());
+    for(auto& program : pendingPartPrograms){
+        program.store(-1);
+    }
     
     apvts.state.addListener(this);
+    startTimerHz(30);
 }
 
 JX11AudioProcessor::~JX11AudioProcessor()
 {
+    stopTimer();
     apvts.state.removeListener(this);
 }
 
@@ -106,12 +130,16 @@ bool JX11AudioProcessor::isMidiEffect() const
 
 double JX11AudioProcessor::getTailLengthSeconds() const
 {
+    // The reverb is the only thing that rings on after the voices stop.
+    if(reverbMixParam->get() > 0.0f) {
+        return reverbDecayParam->get();
+    }
     return 0.0;
 }
 
 int JX11AudioProcessor::getNumPrograms()
 {
-    return int(presets.size());
+    return int(presetBank->presets.size());
 }
 
 int JX11AudioProcessor::getCurrentProgram()
@@ -122,7 +150,12 @@ int JX11AudioProcessor::getCurrentProgram()
 void JX11AudioProcessor::setCurrentProgram (int index)
 {
     currentProgram = index;
-    
+    applyPreset(presetBank->presets[index]);
+    reset();
+}
+
+void JX11AudioProcessor::applyPreset(const Preset& preset)
+{
     juce::RangedAudioParameter *params[NUM_PARAMS] = {
         oscMixParam,
         oscTuneParam,
@@ -152,18 +185,20 @@ void JX11AudioProcessor::setCurrentProgram (int index)
         polyModeParam,
     };
     
-    const Preset& preset = presets[index];
-    
+    // Only touch parameters that actually change. Each notification goes to
+    // the host and through the ValueTree, and most presets leave many of the
+    // parameters at the values they already have.
     for (int i = 0; i < NUM_PARAMS; ++i) {
-        params[i]->setValueNotifyingHost(params[i]->convertTo0to1(preset.param[i]));
+        float value = params[i]->convertTo0to1(preset.param[i]);
+        if (params[i]->getValue() != value) {
+            params[i]->setValueNotifyingHost(value);
+        }
     }
-    
-    reset();
 }
 
 const juce::String JX11AudioProcessor::getProgramName (int index)
 {
-    return { presets[index].name };
+    return { presetBank->presets[index].name };
 }
 
 void JX11AudioProcessor::changeProgramName (int /*index*/, const juce::String& /*newName*/)
@@ -174,20 +209,30 @@ void JX11AudioProcessor::changeProgramName (int /*index*/, const juce::String& /
 //==============================================================================
 void JX11AudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
+    // The host picks the precision before preparing, but both engines are
+    // cheap to keep ready.
     synth.allocateResources(sampleRate, samplesPerBlock);
-    parametersChanged.store(true);
+    doubleSynth.allocateResources(sampleRate, samplesPerBlock);
+    meterFeed.prepare(sampleRate);
+    setLatencySamples(Synth<float>::LATENCY_SAMPLES);
+    publishParams(float(sampleRate));
     reset();
 }
 
 void JX11AudioProcessor::releaseResources()
 {
     synth.deallocateResources();
+    doubleSynth.deallocateResources();
 }
 
 void JX11AudioProcessor::reset()
 {
+    float outputLevel = juce::Decibels::decibelsToGain(outputLevelParam->get());
     synth.reset();
-    synth.outputLevelSmoother.setCurrentAndTargetValue(juce::Decibels::decibelsToGain((outputLevelParam->get())));
+    synth.outputLevelSmoother.setCurrentAndTargetValue(outputLevel);
+    doubleSynth.reset();
+    doubleSynth.outputLevelSmoother.setCurrentAndTargetValue(outputLevel);
+    engineEvents.invalidate();
     midiLearn = synth.resoCC;
 }
 
@@ -218,6 +263,17 @@ bool JX11AudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) con
 #endif
 
 void JX11AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    process(buffer, midiMessages, synth);
+}
+
+void JX11AudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    process(buffer, midiMessages, doubleSynth);
+}
+
+template <typename SampleType>
+void JX11AudioProcessor::process(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages, Synth<SampleType>& engine)
 {
     juce::ScopedNoDenormals noDenormals;
     
@@ -228,32 +284,185 @@ void JX11AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::M
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
     
-    synth.resoCC = midiLearnCC;
+    engine.resoCC = midiLearnCC;
+    
+    // Offline, automation may not reach the ValueTree in time, so build the
+    // snapshot here. Otherwise the audio thread only picks up the newest one.
+    if(isNonRealtime()) {
+        publishParams(float(getSampleRate()));
+    }
+    if(const SynthParams* params = paramsExchange.acquire()) {
+        engine.setParams(*params);
+    }
+    if(const PartParams* partParams = partsExchange.acquire()) {
+        engine.setPartParams(*partParams);
+    }
+    engineEvents.setMapping(engine.params.mpe, engine.params.multiTimbral, engine.resoCC);
+    
+    splitBufferByEvents(buffer, midiMessages, engine);
+    
+    meterFeed.push(buffer.getReadPointer(0),
+                   (buffer.getNumChannels() > 1) ? buffer.getReadPointer(1) : nullptr,
+                   buffer.getNumSamples());
+}
+
+SynthParams JX11AudioProcessor::getParamsSnapshot(float sampleRate)
+{
+    SynthParams params;
+    const std::lock_guard<std::mutex> lock(paramsWriteLock);
+    update(params, sampleRate, getCurrentPart());
+    return params;
+}
+
+std::vector<MultisamplePreset> JX11AudioProcessor::getPresetSnapshots(float sampleRate)
+{
+    const std::lock_guard<std::mutex> lock(paramsWriteLock);
+    
+    // The sound comes from the same mapping a Program Change uses for a part.
+    // Of the other preset values, update() only still reads these three.
+    std::vector<MultisamplePreset> snapshots;
+    for(const Preset& preset : presetBank->presets) {
+        SynthParams params;
+        update(params, sampleRate, partFromPreset(preset, getCurrentPart()));
+        params.glideMode = int(preset.param[3]);
+        params.outputLevel = juce::Decibels::decibelsToGain(preset.param[24]);
+        params.numVoices = (preset.param[25] < 0.5f) ? 1 : Synth<float>::MAX_VOICES;
+        snapshots.push_back({ preset.name, params });
+    }
+    return snapshots;
+}
+
+void JX11AudioProcessor::publishParams(float sampleRate)
+{
+    const std::lock_guard<std::mutex> lock(paramsWriteLock);
+    
+    // Switching Multi on starts every part as the sound on the controls.
+    const bool multi = multiParam->getIndex() == 1;
+    if(multi && !multiWasOn) {
+        parts.fill(getCurrentPart());
+    }
+    multiWasOn = multi;
+    
+    if(sampleRate <= 0.0f) { return; }
+    
+    // The parts are only needed, and only kept up to date, in multi mode.
+    // They go first, so they are there by the time the engine switches.
+    if(multi) {
+        PartParams& partParams = partsExchange.beginWrite();
+        for(size_t ch = 0; ch < parts.size(); ++ch) {
+            update(partParams[ch], sampleRate, parts[ch]);
+        }
+        partsExchange.publish();
+    }
+    
+    update(paramsExchange.beginWrite(), sampleRate, getCurrentPart());
+    paramsExchange.publish();
+}
+
+JX11AudioProcessor::PartSettings JX11AudioProcessor::getCurrentPart() const
+{
+    PartSettings part;
+    part.type = typeParam->get();
+    part.tone = toneParam->get();
+    part.shape = shapeParam->get();
+    part.style = styleParam->get();
+    part.pitchMode = pitchModeParam->getIndex();
+    return part;
+}
+
+void JX11AudioProcessor::setPart(int channel, const PartSettings& part)
+{
+    {
+        const std::lock_guard<std::mutex> lock(paramsWriteLock);
+        parts[size_t(channel)] = part;
+    }
+    publishParams(float(getSampleRate()));
+}
+
+JX11AudioProcessor::PartSettings JX11AudioProcessor::getPart(int channel)
+{
+    const std::lock_guard<std::mutex> lock(paramsWriteLock);
+    return parts[size_t(channel)];
+}
+
+// The presets predate the Type/Tone/Shape/Style controls. Each control
+// takes the preset value it replaced: Osc Tune, Filter Freq, Env Release and
+// Noise. Pitch Mode isn't in the presets, so the part keeps its own.
+JX11AudioProcessor::PartSettings JX11AudioProcessor::partFromPreset(const Preset& preset, PartSettings part) const
+{
+    part.type = juce::jlimit(0.0f, 1.0f, (preset.param[1] + 24.0f) / 24.0f);
+    part.tone = juce::jlimit(0.0f, 100.0f, preset.param[6]);
+    part.shape = juce::jlimit(0.0f, 100.0f, preset.param[18]);
+    part.style = juce::jlimit(0.0f, 1.0f, preset.param[21] / 100.0f);
+    return part;
+}
+
+void JX11AudioProcessor::timerCallback()
+{
+    // setPart takes the parameter lock and rebuilds every part's snapshot,
+    // too much for the audio thread, so Program Changes for the parts are
+    // loaded here.
+    for(int ch = 0; ch < int(pendingPartPrograms.size()); ++ch) {
+        const int program = pendingPartPrograms[size_t(ch)].exchange(-1, std::memory_order_relaxed);
+        if(program >= 0) {
+            setPart(ch, partFromPreset(presetBank->presets[size_t(program)], getPart(ch)));
+        }
+    }
+}
+
+bool JX11AudioProcessor::loadTuning(const juce::String& scl, const juce::String& kbm)
+{
+    Tuning newTuning;
+    if(!newTuning.load(scl.toStdString(), kbm.toStdString())) {
+        return false;
+    }
     
-    bool expected = true;
-    if(isNonRealtime() || parametersChanged.compare_exchange_strong(expected, false)) {
-        update();
+    {
+        const std::lock_guard<std::mutex> lock(paramsWriteLock);
+        microtuning = newTuning;
     }
     
-    splitBufferByEvents(buffer, midiMessages);
+    // The period table goes to the audio thread with the next snapshot.
+    publishParams(float(getSampleRate()));
+    return true;
 }
 
-void JX11AudioProcessor::update()
+void JX11AudioProcessor::update(SynthParams& params, float sampleRate, const PartSettings& part)
 {
-    float sampleRate = float(getSampleRate());
     float inverseSampleRate = 1.0f / sampleRate;
-    const float inverseUpdateRate = inverseSampleRate * synth.LFO_MAX;
+    
+    // Control period in samples for Eco / Normal / High quality.
+    static constexpr int controlPeriods[] = { 64, 32, 8 };
+    params.controlPeriod = controlPeriods[qualityParam->getIndex()];
+    const float inverseUpdateRate = inverseSampleRate * params.controlPeriod;
+    
+    // filterZip was tuned for a 32-sample period, keep its time constant.
+    params.filterZipCoeff = 1.0f - std::pow(0.995f, float(params.controlPeriod) / 32.0f);
     
     // Switches
-    synth.numVoices = (polyModeParam->getIndex() == 0) ? 1 : Synth::MAX_VOICES;
+    params.numVoices = (polyModeParam->getIndex() == 0) ? 1 : Synth<float>::MAX_VOICES;
+    
+    params.glideMode = glideModeParam->getIndex();
+    
+    params.softLimiter = limiterParam->getIndex() == 1;
+    
+    // One decorrelated noise stream per voice instead of one for all.
+    params.perVoiceNoise = noiseModeParam->getIndex() == 1;
+    
+    // Both use the MIDI channel to tell the notes apart, Multi wins.
+    params.multiTimbral = multiParam->getIndex() == 1;
+    params.mpe = !params.multiTimbral && mpeParam->getIndex() == 1;
+    
+    params.ensembleMode = ensembleParam->getIndex();
     
-    synth.glideMode = glideModeParam->getIndex();
+    params.reverbMix = reverbMixParam->get() / 100.0f;
+    params.reverbDecay = reverbDecayParam->get();
     
-    bool pitchMode = pitchModeParam->getIndex();
+    bool pitchMode = part.pitchMode;
     
     //Type
     //float semi = oscTuneParam->get();
-    float semi = typeParam->get();
+    float semi = part.type;
     
       if(semi < 0.33f)
           semi = 0.0f;
@@ -270,83 +479,85 @@ void JX11AudioProcessor::update()
     //float cent = (typeParam->get() * 10) - 5; //Range -10 to +10
     float cent = 0.0f;
     
-    synth.detune = std::pow(1.059463094359f, - semi - 0.01f * cent);
+    params.detune = std::pow(1.059463094359f, - semi - 0.01f * cent);
     
-    //synth.oscMix = oscMixParam->get() / 100.0f;
+    //params.oscMix = oscMixParam->get() / 100.0f;
 
-    //synth.oscMix = setRange(typeParam->get(), 1, 100, 0.2); // Map input range (0-1) to output range (0-100) with a skew of 0.2
-    synth.oscMix = 100;
-    //synth.oscMix = exponentialDecayEquation(typeParam->get(), 100, 10);
+    //params.oscMix = setRange(typeParam->get(), 1, 100, 0.2); // Map input range (0-1) to output range (0-100) with a skew of 0.2
+    params.oscMix = 100;
+    //params.oscMix = exponentialDecayEquation(typeParam->get(), 100, 10);
     
     float glideRate = 1.0f;
     if(pitchMode){
         //float glideRate = glideRateParam->get();
-        glideRate = (typeParam->get() * 20); //Range 1.0f to 20.0f
+        glideRate = (part.type * 20); //Range 1.0f to 20.0f
         if(glideRate < 2.0f){
-            synth.glideRate = 1.0f;
+            params.glideRate = 1.0f;
         }else{
-            synth.glideRate = 1.0f - std::exp(-inverseSampleRate * std::exp(6.0f - 0.07f * glideRate));
+            // Applied once per control tick. It was tuned for a 32-sample
+            // period, so keep that time constant whatever the quality.
+            params.glideRate = 1.0f - std::exp(-inverseUpdateRate / 32.0f * std::exp(6.0f - 0.07f * glideRate));
         }
     }
-    //synth.glideBend = glideBendParam->get();
-    synth.glideBend = 0.0f;
+    //params.glideBend = glideBendParam->get();
+    params.glideBend = 0.0f;
     if(pitchMode){
-        synth.glideBend = (typeParam->get() * 72) - 36; //Range -36.0f to 36.0f
+        params.glideBend = (part.type * 72) - 36; //Range -36.0f to 36.0f
     }
     
     //Tone
-    //synth.filterKeyTracking = 0.08f * filterFreqParam->get() - 1.5f;
-    synth.filterKeyTracking = 0.08f * toneParam->get() - 1.5f;
+    //params.filterKeyTracking = 0.08f * filterFreqParam->get() - 1.5f;
+    params.filterKeyTracking = 0.08f * part.tone - 1.5f;
     
     //float filterReso = filterReleaseParam->get() / 100.0f;
-    float filterReso = toneParam->get() / 100.0f;
-    synth.filterQ = std::exp(3.0f * filterReso);
+    float filterReso = part.tone / 100.0f;
+    params.filterQ = std::exp(3.0f * filterReso);
     
-    //synth.filterEnvDepth = 0.06f * filterEnvParam->get();
-    synth.filterEnvDepth = 0.06f * (toneParam->get() - (toneParam->get() - 100));    //Range -100 to 100
+    //params.filterEnvDepth = 0.06f * filterEnvParam->get();
+    params.filterEnvDepth = 0.06f * (part.tone - (part.tone - 100));    //Range -100 to 100
     
     //float filterLFO = filterLFOParam->get() / 100.0f;
-    float filterLFO = toneParam->get() / 100.0f;
-    synth.filterLFODepth = 2.5f * filterLFO * filterLFO;
+    float filterLFO = part.tone / 100.0f;
+    params.filterLFODepth = 2.5f * filterLFO * filterLFO;
     
     //float filterVelocity = filterVelocityParam->get();
-    float filterVelocity = (toneParam->get() - (toneParam->get() - 100));
+    float filterVelocity = (part.tone - (part.tone - 100));
     if(filterVelocity < -90.0f){
-        synth.velocitySensitivity = 0.0f;
-        synth.ignoreVelocity = true;
+        params.velocitySensitivity = 0.0f;
+        params.ignoreVelocity = true;
     }else{
-        synth.velocitySensitivity = 0.0005f * filterVelocity;
-        synth.ignoreVelocity = false;
+        params.velocitySensitivity = 0.0005f * filterVelocity;
+        params.ignoreVelocity = false;
     }
     
-    //synth.filterAttack = std::exp(-inverseUpdateRate * std::exp(5.5f - 0.075f * filterDecayParam->get()));
-    synth.filterAttack = std::exp(-inverseUpdateRate * std::exp(5.5f - 0.075f * toneParam->get()));
-    //synth.filterDecay = std::exp(-inverseUpdateRate * std::exp(5.5f - 0.075f * filterDecayParam->get()));
-    synth.filterDecay = std::exp(-inverseUpdateRate * std::exp(5.5f - 0.075f * toneParam->get()));
+    //params.filterAttack = std::exp(-inverseUpdateRate * std::exp(5.5f - 0.075f * filterDecayParam->get()));
+    params.filterAttack = std::exp(-inverseUpdateRate * std::exp(5.5f - 0.075f * part.tone));
+    //params.filterDecay = std::exp(-inverseUpdateRate * std::exp(5.5f - 0.075f * filterDecayParam->get()));
+    params.filterDecay = std::exp(-inverseUpdateRate * std::exp(5.5f - 0.075f * part.tone));
     //float filterSustain = filterSustainParam->get() / 100.0f;
-    float filterSustain = toneParam->get() / 100.0f;
-    synth.filterSustain = filterSustain * filterSustain;
-    //synth.filterRelease = std::exp(-inverseUpdateRate * std::exp(5.5f - 0.075f * filterReleaseParam->get()));
-    synth.filterRelease = std::exp(-inverseUpdateRate * std::exp(5.5f - 0.075f * toneParam->get()));
+    float filterSustain = part.tone / 100.0f;
+    params.filterSustain = filterSustain * filterSustain;
+    //params.filterRelease = std::exp(-inverseUpdateRate * std::exp(5.5f - 0.075f * filterReleaseParam->get()));
+    params.filterRelease = std::exp(-inverseUpdateRate * std::exp(5.5f - 0.075f * part.tone));
 
     
     
     //Shape
-    //synth.envAttack = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * envAttackParam->get()));
-    synth.envAttack = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * shapeParam->get()));
+    //params.envAttack = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * envAttackParam->get()));
+    params.envAttack = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * part.shape));
     
-    //synth.envDecay = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * envDecayParam->get()));
-    synth.envDecay = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * shapeParam->get()));
+    //params.envDecay = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * envDecayParam->get()));
+    params.envDecay = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * part.shape));
     
-    //synth.envSustain = envSustainParam->get() / 100.0f;
-    synth.envSustain = shapeParam->get() / 100.0f;
+    //params.envSustain = envSustainParam->get() / 100.0f;
+    params.envSustain = part.shape / 100.0f;
     
     //float envRelease = envReleaseParam->get();
-    float envRelease = shapeParam->get();
+    float envRelease = part.shape;
     if(envRelease < 1.0f){
-        synth.envRelease = 0.75f; // fast release
+        params.envRelease = 0.75f; // fast release
     } else{
-        synth.envRelease = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * envRelease));
+        params.envRelease = std::exp(-inverseSampleRate * std::exp(5.5f - 0.075f * envRelease));
     }
     
     //Style
@@ -354,24 +565,24 @@ void JX11AudioProcessor::update()
     //float lfoRate = std::exp(7.0f * lfoRateParam->get() - 4.0f);
     float lfoRate = 0.0f;
     if(pitchMode)
-        lfoRate = std::exp(7.0f * styleParam->get() - 4.0f);
-    synth.lfoInc = lfoRate * inverseUpdateRate * float(TWO_PI);
+        lfoRate = std::exp(7.0f * part.style - 4.0f);
+    params.lfoInc = lfoRate * inverseUpdateRate * float(TWO_PI);
     
     //float vibrato = vibratoParam->get() / 200.0f;
-    float vibrato = ((styleParam->get() * 100) - 100) / 200;   //Range -100 to 100
-    synth.vibrato = 0.2f * vibrato * vibrato;
-    synth.pwmDepth = synth.vibrato;
-    if(vibrato > 0.0f) { synth.vibrato = 0.0f; }
+    float vibrato = ((part.style * 100) - 100) / 200;   //Range -100 to 100
+    params.vibrato = 0.2f * vibrato * vibrato;
+    params.pwmDepth = params.vibrato;
+    if(vibrato > 0.0f) { params.vibrato = 0.0f; }
 
     //float noiseMix = noiseParam->get() / 100.0f;
-    float noiseMix = styleParam->get();  //Range 0 to 1
+    float noiseMix = part.style;  //Range 0 to 1
     noiseMix *= noiseMix;
-    synth.noiseMix = noiseMix * 0.06f;
+    params.noiseMix = noiseMix * 0.06f;
     
     //float octave = octaveParam->get();
     float octave = 1;
     if(pitchMode){
-        octave = styleParam->get();
+        octave = part.style;
         if(octave < 0.25)
             octave = -2;
         else if(octave < 0.5)
@@ -388,57 +599,76 @@ void JX11AudioProcessor::update()
     //    tuning = (styleParam->get() * 20) - 10;    //Range -10 to 10
     
     float tuneInSemi = -36.3763f - 12.0f * octave - tuning / 100.0f;
-    synth.tune = sampleRate * std::exp(0.05776226505f * tuneInSemi); //octave * 12.0f + tuning / 100.0f;
+    params.tune = sampleRate * std::exp(0.05776226505f * tuneInSemi); //octave * 12.0f + tuning / 100.0f;
     
-    synth.outputLevelSmoother.setTargetValue(juce::Decibels::decibelsToGain(outputLevelParam->get()));
-    synth.volumeTrim = 0.0008f * (3.2f - synth.oscMix - 25.0f * synth.noiseMix) * (1.5f - 0.5f * filterReso);
+    for(int n = 0; n < Tuning::NUM_NOTES; ++n){
+        float pitch = microtuning.getSemitones(n);
+        params.notePeriod[n] = std::isnan(pitch) ? 0.0f : params.tune * std::exp(-0.05776226505f * pitch);
+    }
+    
+    params.outputLevel = juce::Decibels::decibelsToGain(outputLevelParam->get());
+    
+    // The lowest setting turns early voice termination off.
+    float voiceFloor = voiceFloorParam->get();
+    params.voiceFloor = (voiceFloor <= voiceFloorParam->range.start) ? 0.0f : juce::Decibels::decibelsToGain(voiceFloor);
+    
+    // The held signal level falls with a 100 ms time constant.
+    params.voicePowerFall = std::exp(-float(params.controlPeriod) / (0.1f * sampleRate));
+    params.volumeTrim = 0.0008f * (3.2f - params.oscMix - 25.0f * params.noiseMix) * (1.5f - 0.5f * filterReso);
     
 }
 
-void JX11AudioProcessor::splitBufferByEvents(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+template <typename SampleType>
+void JX11AudioProcessor::splitBufferByEvents(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages, Synth<SampleType>& engine)
 {
+    // The engine applies the events itself while it renders, so a block full
+    // of controller data is still rendered in one call. It only has to be
+    // split when a program change resets the engine, or if the event list
+    // fills up.
     int bufferOffset = 0;
+    engineEvents.clear();
     
-    // Loop
     for(const auto metadata : midiMessages) {
+        // Ignore MIDI messages such as sysex.
+        if(metadata.numBytes > 3) { continue; }
         
-        // Render the audio that happens before this event (if any).
-        int samplesThisSegment = metadata.samplePosition - bufferOffset;
-        if(samplesThisSegment > 0) {
-            render(buffer, samplesThisSegment, bufferOffset);
-            bufferOffset += samplesThisSegment;
+        uint8_t data0 = metadata.data[0];
+        uint8_t data1 = (metadata.numBytes >= 2) ? metadata.data[1] : 0;
+        uint8_t data2 = (metadata.numBytes == 3) ? metadata.data[2] : 0;
+        
+        int samplePosition = std::min(metadata.samplePosition, buffer.getNumSamples());
+        if(((data0 & 0xF0) == 0xC0) || engineEvents.isFull()) {
+            render(buffer, samplePosition - bufferOffset, bufferOffset, engine);
+            bufferOffset = samplePosition;
         }
         
-        // Handle the event. Ignore MIDI messages such as sysex.
-        if(metadata.numBytes <= 3){
-            uint8_t data1 = (metadata.numBytes >= 2) ? metadata.data[1] : 0;
-            uint8_t data2 = (metadata.numBytes == 3) ? metadata.data[2] : 0;
-            handleMIDI(metadata.data[0], data1, data2);
+        if(handleMIDI(data0, data1, data2)) {
+            engineEvents.add(samplePosition - bufferOffset, data0, data1, data2);
         }
     }
     
-    // Render the audio after the last MIDI event. If there were no
-    // MIDI events at all, this renders the entire buffer.
-    int samplesLastSegment = buffer.getNumSamples() - bufferOffset;
-    if(samplesLastSegment > 0){
-        render(buffer, samplesLastSegment, bufferOffset);
-    }
+    // Render the rest of the buffer, or all of it if there was no split.
+    render(buffer, buffer.getNumSamples() - bufferOffset, bufferOffset, engine);
     
     midiMessages.clear();
 }
 
-void JX11AudioProcessor::handleMIDI(uint8_t data0, uint8_t data1, uint8_t data2)
+bool JX11AudioProcessor::handleMIDI(uint8_t data0, uint8_t data1, uint8_t data2)
 {
     if (midiLearn && ((data0 & 0xF0) == 0xB0)){
         DBG("learned a MIDI CC");
         midiLearnCC = data1;
-        return;
+        return false;
     }
     
-    // Program Change
+    // Program Change, for one part in multi mode
     if ((data0 & 0xF0) == 0xC0) {
-        if (data1 < presets.size()) {
-            setCurrentProgram(data1);
+        if (data1 < presetBank->presets.size()) {
+            if (multiParam->getIndex() == 1) {
+                pendingPartPrograms[size_t(data0 & 0x0F)].store(data1, std::memory_order_relaxed);
+            } else {
+                setCurrentProgram(data1);
+            }
         }
     }
     // Control Change
@@ -452,18 +682,46 @@ void JX11AudioProcessor::handleMIDI(uint8_t data0, uint8_t data1, uint8_t data2)
         }
     }
     
-    synth.midiMessage(data0, data1, data2);
+    return true;
 }
 
-void JX11AudioProcessor::render(juce::AudioBuffer<float>& buffer, int sampleCount, int bufferOffset)
+template <typename SampleType>
+void JX11AudioProcessor::render(juce::AudioBuffer<SampleType>& buffer, int sampleCount, int bufferOffset, Synth<SampleType>& engine)
 {
-    float* outputBuffers[2] = { nullptr, nullptr };
+    SampleType* outputBuffers[2] = { nullptr, nullptr };
     outputBuffers[0] = buffer.getWritePointer(0) + bufferOffset;
     if(getTotalNumOutputChannels() > 1) {
         outputBuffers[1] = buffer.getWritePointer(1) + bufferOffset;
     }
     
-    synth.render(outputBuffers, sampleCount);
+    // The events are used up even if there is nothing to render.
+    engineEvents.coalesce(engine.params.controlPeriod);
+    engine.render(outputBuffers, sampleCount, engineEvents.data(), engineEvents.size());
+    engineEvents.clear();
+    
+    // Before a program change, so it goes to the preset that was playing.
+    // With Multi on, each channel plays its own part instead.
+    const bool multi = engine.params.multiTimbral;
+    for(size_t ch = 0; ch < engine.voiceSamplesRendered.size(); ++ch){
+        if(engine.voiceSamplesRendered[ch] == 0 && engine.voiceSamplesSaved[ch] == 0){ continue; }
+        
+        VoiceUsage& usage = multi ? partUsage[ch] : voiceUsage[size_t(currentProgram)];
+        usage.rendered.fetch_add(engine.voiceSamplesRendered[ch], std::memory_order_relaxed);
+        usage.saved.fetch_add(engine.voiceSamplesSaved[ch], std::memory_order_relaxed);
+        engine.voiceSamplesRendered[ch] = 0;
+        engine.voiceSamplesSaved[ch] = 0;
+    }
+}
+
+JX11AudioProcessor::OutputGuardCounts JX11AudioProcessor::getOutputGuardCounts() const
+{
+    OutputGuardCounts counts;
+    for(const OutputGuardStats* stats : { &synth.outputStats, &doubleSynth.outputStats }){
+        counts.nonFinite += stats->nonFinite.load(std::memory_order_relaxed);
+        counts.screaming += stats->screaming.load(std::memory_order_relaxed);
+        counts.clamped += stats->clamped.load(std::memory_order_relaxed);
+    }
+    return counts;
 }
 
 //==============================================================================
@@ -488,7 +746,29 @@ void JX11AudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     xml->addChildElement(parametersXML.release());
     auto extraXML = std::make_unique<juce::XmlElement>(extraTag);
     extraXML->setAttribute(midiCCAttribute, midiLearnCC);
+    {
+        const std::lock_guard<std::mutex> lock(paramsWriteLock);
+        if(!microtuning.getScaleText().empty()){
+            extraXML->setAttribute(sclAttribute, juce::String(microtuning.getScaleText()));
+        }
+        if(!microtuning.getMappingText().empty()){
+            extraXML->setAttribute(kbmAttribute, juce::String(microtuning.getMappingText()));
+        }
+    }
     xml->addChildElement(extraXML.release());
+    
+    auto partsXML = std::make_unique<juce::XmlElement>(partsTag);
+    for(int ch = 0; ch < int(parts.size()); ++ch){
+        PartSettings part = getPart(ch);
+        auto* partXML = partsXML->createNewChildElement(partTag);
+        partXML->setAttribute("type", part.type);
+        partXML->setAttribute("tone", part.tone);
+        partXML->setAttribute("shape", part.shape);
+        partXML->setAttribute("style", part.style);
+        partXML->setAttribute("pitchMode", part.pitchMode);
+    }
+    xml->addChildElement(partsXML.release());
+    
     copyXmlToBinary(*xml, destData);
     DBG(xml->toString());
 }
@@ -500,7 +780,7 @@ void JX11AudioProcessor::setStateInformation (const void* data, int sizeInBytes)
         
         if(auto* parametersXML = xml->getChildByName(apvts.state.getType())){
             apvts.replaceState(juce::ValueTree::fromXml(*parametersXML));
-            parametersChanged.store(true);
+            publishParams(float(getSampleRate()));
         }
         
         if(auto* extraXML = xml->getChildByName(extraTag)){
@@ -508,11 +788,28 @@ void JX11AudioProcessor::setStateInformation (const void* data, int sizeInBytes)
             if(midiCC != 0){
                 midiLearnCC = static_cast<uint8_t>(midiCC);
             }
+            
+            loadTuning(extraXML->getStringAttribute(sclAttribute), extraXML->getStringAttribute(kbmAttribute));
+        }
+        
+        // Older states have no parts; they keep playing the loaded sound.
+        if(auto* partsXML = xml->getChildByName(partsTag)){
+            int ch = 0;
+            for(auto* partXML : partsXML->getChildWithTagNameIterator(partTag.toString())){
+                if(ch == int(parts.size())){ break; }
+                PartSettings part;
+                part.type = float(partXML->getDoubleAttribute("type"));
+                part.tone = float(partXML->getDoubleAttribute("tone"));
+                part.shape = float(partXML->getDoubleAttribute("shape"));
+                part.style = float(partXML->getDoubleAttribute("style"));
+                part.pitchMode = partXML->getIntAttribute("pitchMode");
+                setPart(ch++, part);
+            }
         }
     }
 }
 
-void JX11AudioProcessor::createPrograms()
+PresetBank::PresetBank()
 {
     presets.emplace_back("Init", 0.00f, -12.00f, 0.00f, 0.00f, 35.00f, 0.00f, 100.00f, 15.00f, 50.00f, 0.00f, 0.00f, 0.00f, 30.00f, 0.00f, 25.00f, 0.00f, 50.00f, 100.00f, 30.00f, 0.81f, 0.00f, 0.00f, 0.00f, 0.00f, 0.00f, 1.00f);
     presets.emplace_back("5th Sweep Pad", 100.00f, -7.00f, -6.30f, 1.00f, 32.00f, 0.00f, 90.00f, 60.00f, -76.00f, 0.00f, 0.00f, 90.00f, 89.00f, 90.00f, 73.00f, 0.00f, 50.00f, 100.00f, 71.00f, 0.81f, 30.00f, 0.00f, 0.00f, 0.00f, 0.00f, 1.00f);
@@ -592,6 +889,68 @@ juce::AudioProcessorValueTreeState::ParameterLayout JX11AudioProcessor::createPa
         juce::StringArray { "On", "Off"},
         0));
     
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID::quality,
+        "Quality",
+        juce::StringArray { "Eco", "Normal", "High" },
+        1));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID::limiter,
+        "Limiter",
+        juce::StringArray { "Off", "On" },
+        0));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID::noiseMode,
+        "Noise Mode",
+        juce::StringArray { "Shared", "Per Voice" },
+        0));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID::mpe,
+        "MPE",
+        juce::StringArray { "Off", "On" },
+        0));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID::multi,
+        "Multi",
+        juce::StringArray { "Off", "On" },
+        0));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        ParameterID::ensemble,
+        "Ensemble",
+        juce::StringArray { "Off", "I", "II" },
+        0));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID::reverbMix,
+        "Reverb Mix",
+        juce::NormalisableRange<float>(0.0f, 100.0f, 1.0f),
+        0.0f,
+        juce::AudioParameterFloatAttributes().withLabel("%")));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID::reverbDecay,
+        "Reverb Decay",
+        juce::NormalisableRange<float>(0.3f, 10.0f, 0.01f, 0.4f),
+        2.0f,
+        juce::AudioParameterFloatAttributes().withLabel("s")));
+    
+    auto voiceFloorStringFromValue = [](float value, int)
+    {
+        return (value <= -120.0f) ? juce::String("Off") : juce::String(value, 0) + " dB";
+    };
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        ParameterID::voiceFloor,
+        "Voice Floor",
+        juce::NormalisableRange<float>(-120.0f, -60.0f, 1.0f),
+        -96.0f,
+        juce::AudioParameterFloatAttributes().withStringFromValueFunction(voiceFloorStringFromValue)));
+    
     //Type-------------------------------------------------
     layout.add(std::make_unique<juce::AudioParameterFloat>(
         ParameterID::type,
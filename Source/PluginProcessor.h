@@ -11,6 +11,9 @@
 #include <JuceHeader.h>
 #include "Synth.h"
 #include "Preset.h"
+#include "MeterFeed.h"
+#include "Tuning.h"
+#include "MultisampleRenderer.h"
 
 namespace ParameterID 
 {
@@ -48,6 +51,15 @@ namespace ParameterID
     PARAMETER_ID(tuning)
     PARAMETER_ID(outputLevel)
     PARAMETER_ID(polyMode)
+    PARAMETER_ID(quality)
+    PARAMETER_ID(limiter)
+    PARAMETER_ID(noiseMode)
+    PARAMETER_ID(mpe)
+    PARAMETER_ID(multi)
+    PARAMETER_ID(ensemble)
+    PARAMETER_ID(reverbMix)
+    PARAMETER_ID(reverbDecay)
+    PARAMETER_ID(voiceFloor)
 
     #undef PARAMETER_ID
 }
@@ -55,7 +67,7 @@ namespace ParameterID
 //==============================================================================
 /**
 */
-class JX11AudioProcessor  : public juce::AudioProcessor, private juce::ValueTree::Listener
+class JX11AudioProcessor  : public juce::AudioProcessor, private juce::ValueTree::Listener, private juce::Timer
 {
 public:
     //==============================================================================
@@ -72,6 +84,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -98,23 +112,87 @@ public:
     
     juce::AudioProcessorValueTreeState apvts{*this, nullptr, "Parameters", createParameterLayout()};
     
-    std::atomic<bool> midiLearn;
+    std::atomic<bool> midiLearn { false };
+    
+    MeterFeed meterFeed;
+    
+    // Scala scale and keyboard mapping text. Empty strings mean 12-TET and the
+    // default mapping. Returns false, keeping the current tuning, on a parse error.
+    bool loadTuning(const juce::String& scl, const juce::String& kbm);
+    
+    // The engine settings for the current parameter values, for rendering
+    // outside the host's audio callback (see OfflineRenderer).
+    SynthParams getParamsSnapshot(float sampleRate);
+    
+    // Engine settings for every built-in preset, for MultisampleRenderer.
+    // Built from the presets directly; the parameters aren't touched, so the
+    // running sound doesn't change.
+    std::vector<MultisamplePreset> getPresetSnapshots(float sampleRate);
+    
+    // Times the output guard stepped in, both engines together.
+    struct OutputGuardCounts
+    {
+        uint32_t nonFinite = 0;
+        uint32_t screaming = 0;
+        uint32_t clamped = 0;
+    };
+    OutputGuardCounts getOutputGuardCounts() const;
+    
+    // How much of the incoming MIDI the engine actually had to handle.
+    const MidiEventStats& getMidiEventStats() const { return engineEvents.stats; }
+    
+    // Voice-samples rendered with a preset, and how many more the envelopes
+    // alone would have needed before the voices were ended at the floor.
+    struct VoiceUsage
+    {
+        std::atomic<uint64_t> rendered { 0 };
+        std::atomic<uint64_t> saved { 0 };
+    };
+    const VoiceUsage& getVoiceUsage(int program) const { return voiceUsage[size_t(program)]; }
+    
+    // The same for the part on a MIDI channel (0-15), while Multi is on.
+    const VoiceUsage& getPartVoiceUsage(int channel) const { return partUsage[size_t(channel)]; }
+    bool isMultiTimbral() const { return multiParam->getIndex() == 1; }
+    
+    // The controls that make up a sound. With the Multi parameter on, each
+    // MIDI channel plays its own part; they all start as the sound that was
+    // on the controls when Multi was switched on, and a Program Change on a
+    // channel loads that preset into its part.
+    struct PartSettings
+    {
+        float type = 0.0f;
+        float tone = 0.0f;
+        float shape = 0.0f;
+        float style = 0.0f;
+        int pitchMode = 0;
+    };
+    void setPart(int channel, const PartSettings& part);
+    PartSettings getPart(int channel);
 
 private:
-    void splitBufferByEvents(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages);
-    void handleMIDI(uint8_t data0, uint8_t data1, uint8_t data2);
-    void render(juce::AudioBuffer<float>& buffer, int sampleCount, int bufferOffset);
+    template <typename SampleType>
+    void process(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages, Synth<SampleType>& engine);
+    template <typename SampleType>
+    void splitBufferByEvents(juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages, Synth<SampleType>& engine);
+    bool handleMIDI(uint8_t data0, uint8_t data1, uint8_t data2);
+    template <typename SampleType>
+    void render(juce::AudioBuffer<SampleType>& buffer, int sampleCount, int bufferOffset, Synth<SampleType>& engine);
     void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override
     {
         DBG("parameter changed");
-        parametersChanged.store(true);
+        publishParams(float(getSampleRate()));
     }
-    void update();
-    void createPrograms();
-    std::vector<Preset> presets;
+    void publishParams(float sampleRate);
+    void timerCallback() override;
+    PartSettings partFromPreset(const Preset& preset, PartSettings part) const;
+    void update(SynthParams& params, float sampleRate, const PartSettings& part);
+    PartSettings getCurrentPart() const;
+    void applyPreset(const Preset& preset);
+    juce::SharedResourcePointer<PresetBank> presetBank;
     int currentProgram;
 private:
-    Synth synth;
+    Synth<float> synth;
+    Synth<double> doubleSynth;
     
     juce::AudioParameterFloat* oscMixParam;
     juce::AudioParameterFloat* oscTuneParam;
@@ -148,15 +226,40 @@ private:
     juce::AudioParameterFloat* shapeParam;
     juce::AudioParameterFloat* styleParam;
     juce::AudioParameterChoice* pitchModeParam;
+    juce::AudioParameterChoice* qualityParam;
+    juce::AudioParameterChoice* limiterParam;
+    juce::AudioParameterChoice* noiseModeParam;
+    juce::AudioParameterChoice* mpeParam;
+    juce::AudioParameterChoice* multiParam;
+    juce::AudioParameterChoice* ensembleParam;
+    juce::AudioParameterFloat* reverbMixParam;
+    juce::AudioParameterFloat* reverbDecayParam;
+    juce::AudioParameterFloat* voiceFloorParam;
     
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     
     float setRange(float input, float maxX, float maxY, float skew);
     float exponentialDecayEquation(float input, float maxY, float skew);
     
-    std::atomic<bool> parametersChanged{ false };
+    SnapshotExchange<SynthParams> paramsExchange;
+    std::mutex paramsWriteLock;
+    Tuning microtuning;   // guarded by paramsWriteLock
+    std::array<PartSettings, 16> parts;   // guarded by paramsWriteLock
+    bool multiWasOn = false;              // guarded by paramsWriteLock
+    SnapshotExchange<PartParams> partsExchange;
+    
+    std::atomic<uint8_t> midiLearnCC { 0x47 };
+    
+    // Program Changes for the parts, one per channel, -1 when none. Set on
+    // the audio thread and loaded by the timer on the message thread.
+    std::array<std::atomic<int>, 16> pendingPartPrograms;
+    
+    // MIDI for the engine in the current block.
+    MidiEventQueue engineEvents;
     
-    std::atomic<uint8_t> midiLearnCC;
+    // One entry per preset, and one per part.
+    std::unique_ptr<VoiceUsage[]> voiceUsage;
+    std::array<VoiceUsage, 16> partUsage;
     
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (JX11AudioProcessor)
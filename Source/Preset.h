@@ -11,6 +11,7 @@
 #pragma once
 
 #include <cstring>
+#include <vector>
 
 const int NUM_PARAMS = 26;
 
@@ -57,3 +58,12 @@ struct Preset
     char name[40];
     float param[NUM_PARAMS];
 };
+
+// The factory bank. It never changes, so every plug-in instance shares one
+// copy through juce::SharedResourcePointer.
+struct PresetBank
+{
+    PresetBank();
+    
+    std::vector<Preset> presets;
+};
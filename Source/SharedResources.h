@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    SharedResources.h
+    Created: 19 Oct 2026 1:05:12pm
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Immutable data that is the same for every plug-in instance. Hold these
+// through juce::SharedResourcePointer: the first holder in the process builds
+// the object, later ones just take a reference, and the last one to go away
+// deletes it.
+
+// Lookup tables used by the DSP code.
+struct SharedTables
+{
+    juce::dsp::LookupTableTransform<float> tanh { [] (float x) { return std::tanh(x); }, -5.0f, 5.0f, 128 };
+    juce::dsp::LookupTableTransform<double> tanhDouble { [] (double x) { return std::tanh(x); }, -5.0, 5.0, 128 };
+    
+    template <typename SampleType>
+    const juce::dsp::LookupTableTransform<SampleType>& getTanh() const
+    {
+        if constexpr (std::is_same_v<SampleType, double>) { return tanhDouble; }
+        else { return tanh; }
+    }
+};
+
+// Typefaces embedded in BinaryData.
+struct SharedFonts
+{
+    juce::Typeface::Ptr latoMedium = juce::Typeface::createSystemTypefaceFor(BinaryData::LatoMedium_ttf, BinaryData::LatoMedium_ttfSize);
+};
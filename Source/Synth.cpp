@@ -9,14 +9,24 @@
 */
 
 #include "Synth.h"
-#include "Utils.h"
+#include <optional>
 
 static const float ANALOG = 0.002f;
 static const int SUSTAIN = -1;
 
-Synth::Synth()
+template <typename SampleType>
+Synth<SampleType>::Synth()
 {
     sampleRate = 44100.0f;
+    kernels = &DspKernels<SampleType>::get(CpuVariant::generic);
+    voiceEndPower = 0;
+    fadeLength = 128;
+    activeFades = 0;
+    
+    // Each voice is detuned a tiny bit, like the components of an analog synth.
+    for(int v = 0; v < MAX_VOICES; ++v){
+        analogDetune[v] = std::exp(SampleType(-0.05776226505) * SampleType(ANALOG) * SampleType(v));
+    }
 }
 
 
@@ -29,7 +39,8 @@ Synth::Synth()
 //    }
 //}
 
-void Synth::allocateResources(double sampleRate_, int samplesPerBlock)
+template <typename SampleType>
+void Synth<SampleType>::allocateResources(double sampleRate_, int samplesPerBlock)
 {
     sampleRate = static_cast<float>(sampleRate_);
     
@@ -38,22 +49,68 @@ void Synth::allocateResources(double sampleRate_, int samplesPerBlock)
     spec.maximumBlockSize = samplesPerBlock;
     spec.numChannels = 1;
 
+    cutoffTable.prepare(sampleRate_);
+    
     for(int v = 0; v < MAX_VOICES; ++v){
         voices[v].filter.setMode(juce::dsp::LadderFilterMode::LPF12);
-        voices[v].filter.prepare(spec);
+        voices[v].filter.prepare(spec, cutoffTable);
+    }
+    
+    for(int v = 0; v < MAX_VOICES; ++v){
+        voices[v].filter.setRampLength(params.controlPeriod);
     }
+    
+    // Long enough to hide the step, short enough to sound like the
+    // old note simply stopped.
+    fadeLength = std::max(1, int(sampleRate_ * 0.003));
+    
+    ensemble.prepare(sampleRate_);
+    reverb.prepare(sampleRate_);
+    limiter.prepare(sampleRate);
+    
+    kernels = &DspKernels<SampleType>::get(chooseCpuVariant());
 }
 
+template <typename SampleType>
+void Synth<SampleType>::setParams(const SynthParams& newParams)
+{
+    params = newParams;
+    params.controlPeriod = std::clamp(params.controlPeriod, 1, MAX_CONTROL_PERIOD);
+    
+    for(int v = 0; v < MAX_VOICES; ++v){
+        voices[v].filter.setRampLength(params.controlPeriod);
+    }
+    
+    outputLevelSmoother.setTargetValue(params.outputLevel);
+    ensemble.setMode(params.ensembleMode);
+    reverb.setDecayTime(params.reverbDecay);
+    reverb.setMix(params.reverbMix);
+}
 
-void Synth::deallocateResources()
+template <typename SampleType>
+void Synth<SampleType>::setPartParams(const PartParams& newParts)
+{
+    parts = newParts;
+    
+    partsUseNoise = false;
+    for(const SynthParams& part : parts){
+        partsUseNoise = partsUseNoise || part.noiseMix != 0.0f;
+    }
+}
+
+
+template <typename SampleType>
+void Synth<SampleType>::deallocateResources()
 {
     // do nothing
 }
 
-void Synth::reset()
+template <typename SampleType>
+void Synth<SampleType>::reset()
 {
     for (int v = 0; v < MAX_VOICES; ++v){
         voices[v].reset();
+        voices[v].noiseGen.reset(v + 1);
     }
     
     noiseGen.reset();
@@ -68,116 +125,366 @@ void Synth::reset()
     pressure = 0.0f;
     filterCtl = 0.0f;
     filterZip = 0.0f;
+    channelPitchBend.fill(1);
+    channelPressure.fill(0);
+    channelSlide.fill(0);
+    partLfo.fill(0);
+    partFilterZip.fill(0);
+    channelSustain.fill(false);
+    for(auto& fade : fades){
+        fade = { 0, 0, 0, 0, 0 };
+    }
+    activeFades = 0;
+    ensemble.reset();
+    reverb.reset();
+    limiter.reset();
 }
 
-void Synth::render(float** outputBuffers, int sampleCount)
+template <typename SampleType>
+void Synth<SampleType>::render(SampleType** outputBuffers, int sampleCount, const SynthEvent* events, int numEvents)
 {
-    float* outputBufferLeft = outputBuffers[0];
-    float* outputBufferRight = outputBuffers[1];
+    // Release tails, the reverb and the saw integrator all decay towards
+    // zero. Not every caller is a host's audio thread that already has FTZ
+    // and DAZ set, so the engine sets them itself.
+    std::optional<juce::ScopedNoDenormals> noDenormals;
+    if(flushDenormals){
+        noDenormals.emplace();
+    }
+    
+    SampleType* outputBufferLeft = outputBuffers[0];
+    SampleType* outputBufferRight = outputBuffers[1];
+    
+    updateVoiceControls();
+    
+    // Fading voices are ended once envelope^2 * signal power falls below
+    // this, which puts their output under the floor at the current level.
+    const SampleType outputLevel = outputLevelSmoother.getTargetValue();
+    const SampleType floor = SampleType(params.voiceFloor);
+    voiceEndPower = (outputLevel > SampleType(1e-6)) ? (floor * floor) / (outputLevel * outputLevel)
+                                                     : ((floor > 0) ? SampleType(1e9) : SampleType(0));
+
+    // Everything that stays the same for the whole block is decided here,
+    // once, by picking the matching compiled kernel.
+    const bool stereo = outputBufferRight != nullptr;
+    NoiseMode noiseMode = (params.noiseMix == 0.0f) ? NoiseMode::none
+                        : params.perVoiceNoise ? NoiseMode::perVoice : NoiseMode::shared;
+    
+    // Parts may each have their own amount of noise, so they always get a
+    // source per voice.
+    if(params.multiTimbral){
+        noiseMode = partsUseNoise ? NoiseMode::perVoice : NoiseMode::none;
+    }
+    
+    if(!specializeRender){
+        // The benchmark baseline; stereo and noise are tested as it goes.
+        renderRuns<true, NoiseMode::none, false>(outputBufferLeft, outputBufferRight, sampleCount, events, numEvents);
+    }else{
+        switch(noiseMode){
+            case NoiseMode::none:
+                if(stereo) { renderRuns<true, NoiseMode::none, true>(outputBufferLeft, outputBufferRight, sampleCount, events, numEvents); }
+                else       { renderRuns<false, NoiseMode::none, true>(outputBufferLeft, outputBufferRight, sampleCount, events, numEvents); }
+                break;
+            case NoiseMode::shared:
+                if(stereo) { renderRuns<true, NoiseMode::shared, true>(outputBufferLeft, outputBufferRight, sampleCount, events, numEvents); }
+                else       { renderRuns<false, NoiseMode::shared, true>(outputBufferLeft, outputBufferRight, sampleCount, events, numEvents); }
+                break;
+            case NoiseMode::perVoice:
+                if(stereo) { renderRuns<true, NoiseMode::perVoice, true>(outputBufferLeft, outputBufferRight, sampleCount, events, numEvents); }
+                else       { renderRuns<false, NoiseMode::perVoice, true>(outputBufferLeft, outputBufferRight, sampleCount, events, numEvents); }
+                break;
+        }
+    }
+    
+    resetFinishedVoices();
+    
+    if(ensemble.isActive()){
+        ensemble.process(outputBufferLeft, outputBufferRight, sampleCount, *kernels);
+    }
+    
+    if(reverb.isActive()){
+        reverb.process(outputBufferLeft, outputBufferRight, sampleCount, *kernels);
+    }
     
+    if(params.softLimiter){
+        limiter.process(outputBufferLeft, outputBufferRight, sampleCount);
+    }else{
+        limiter.bypass(outputBufferLeft, outputBufferRight, sampleCount);
+    }
     
+    protectYourEars(outputBufferLeft, sampleCount, outputStats);
+    protectYourEars(outputBufferRight, sampleCount, outputStats);
+}
+
+template <typename SampleType>
+void Synth<SampleType>::updateVoiceControls()
+{
     for (int v = 0; v < MAX_VOICES; ++v){
-        Voice& voice = voices[v];
+        VoiceType& voice = voices[v];
         if(voice.env.isActive()){
+            voice.setPitchBend(pitchBend * voice.notePitchBend);
             updatePeriod(voice);
-            voice.glideRate = glideRate;
-            voice.filterQ = filterQ * resonanceCtl;
-            voice.pitchBend = pitchBend;
-            voice.filterEnvDepth = filterEnvDepth;
+            const SynthParams& part = partFor(voice.channel);
+            voice.glideRate = part.glideRate;
+            voice.filterQ = part.filterQ * resonanceCtl;
+            voice.filterEnvDepth = part.filterEnvDepth;
         }
     }
+}
 
-    for(int sample = 0; sample < sampleCount; ++sample){
-        updateLFO();
-        const float noise = noiseGen.nextValue() * noiseMix;
+template <typename SampleType>
+void Synth<SampleType>::resetFinishedVoices()
+{
+    for (int v = 0; v < MAX_VOICES; ++v){
+        VoiceType& voice = voices[v];
+        if(!voice.env.isActive()){
+            voice.env.reset();
+            voice.filter.reset();
+        }
+    }
+}
 
-        float outputLeft = 0.0f;
-        float outputRight = 0.0f;
+template <typename SampleType>
+void Synth<SampleType>::endIfInaudible(VoiceType& voice)
+{
+    if(voice.env.isFadingOut() && voice.env.level * voice.env.level * voice.signalPower < voiceEndPower){
+        voiceSamplesSaved[size_t(voice.channel)] += uint64_t(voice.env.samplesUntilSilent());
+        voice.env.reset();
+    }
+}
+
+template <typename SampleType>
+void Synth<SampleType>::fadeOutStolenVoice(int v)
+{
+    VoiceType& voice = voices[v];
+    Fade& fade = fades[v];
+    
+    if(fade.remaining == 0){
+        fade.left = 0;
+        fade.right = 0;
+        ++activeFades;
+    }
+    fade.left += voice.lastLeft;
+    fade.right += voice.lastRight;
+    fade.remaining = fadeLength;
+    fade.stepLeft = fade.left / SampleType(fadeLength);
+    fade.stepRight = fade.right / SampleType(fadeLength);
+    
+    // The new note starts from silence instead of where the old one was.
+    voice.env.reset();
+    voice.filter.reset();
+    voice.saw = 0;
+    voice.lastLeft = 0;
+    voice.lastRight = 0;
+}
+
+template <typename SampleType>
+void Synth<SampleType>::renderFades(int sampleCount)
+{
+    for(auto& fade : fades){
+        if(fade.remaining == 0){ continue; }
+        
+        const int count = std::min(sampleCount, fade.remaining);
+        for(int i = 0; i < count; ++i){
+            fade.left -= fade.stepLeft;
+            fade.right -= fade.stepRight;
+            mixLeft[i] += fade.left;
+            mixRight[i] += fade.right;
+        }
+        
+        fade.remaining -= count;
+        if(fade.remaining == 0){
+            --activeFades;
+        }
+    }
+}
+
+template <typename SampleType>
+template <bool stereo, typename Synth<SampleType>::NoiseMode noiseMode, bool fixedFlags>
+void Synth<SampleType>::renderRuns(SampleType* outputBufferLeft, SampleType* outputBufferRight, int sampleCount,
+                                   const SynthEvent* events, int numEvents)
+{
+    // Without fixedFlags, stereo and noiseMode are ignored and the settings
+    // are tested as the loop goes, with the noise always mixed in. In the
+    // compiled kernels all of these are constants.
+    constexpr bool withNoise = !fixedFlags || noiseMode != NoiseMode::none;
+    const bool isStereo = fixedFlags ? stereo : (outputBufferRight != nullptr);
+    const bool perVoiceNoise = fixedFlags ? (noiseMode == NoiseMode::perVoice) : (params.multiTimbral || params.perVoiceNoise);
+    const bool sharedNoise = fixedFlags ? (noiseMode == NoiseMode::shared) : !perVoiceNoise;
+    
+    // Render in runs that end on the next control-rate tick, so the
+    // envelopes can be computed a whole run at a time for every voice. An
+    // event only shortens the run it falls in; the block setup, the kernel
+    // choice and the limiter still happen once per block.
+    int sample = 0;
+    int eventIndex = 0;
+    while(sample < sampleCount){
+        if(eventIndex < numEvents && events[eventIndex].sampleOffset <= sample){
+            resetFinishedVoices();
+            while(eventIndex < numEvents && events[eventIndex].sampleOffset <= sample){
+                handleEvent(events[eventIndex++]);
+            }
+            updateVoiceControls();
+        }
+        
+        const int runEnd = (eventIndex < numEvents) ? std::min(events[eventIndex].sampleOffset, sampleCount) : sampleCount;
+        
+        updateLFO();
+        const int runLength = std::min(lfoStep, runEnd - sample);
+        lfoStep -= runLength - 1;
         
+        juce::FloatVectorOperations::clear(mixLeft, runLength);
+        juce::FloatVectorOperations::clear(mixRight, runLength);
+        
+        if(sharedNoise){
+            kernels->fillNoise(noiseGen, noiseBlock, SampleType(params.noiseMix), runLength);
+        }
+        
+        // The envelopes of all active voices in one pass, a voice per lane.
+        Envelope<SampleType>* envelopes[MAX_VOICES];
         for (int v = 0; v < MAX_VOICES; ++v){
-            Voice& voice = voices[v];
-            if(voice.env.isActive()){
-                float output = voice.render(noise);
-                outputLeft += output * voice.panLeft;
-                outputRight += output * voice.panRight;
+            envelopes[v] = voices[v].env.isActive() ? &voices[v].env : nullptr;
+        }
+        Envelope<SampleType>::renderLanes(envelopes, envelopeFrames, runLength, *kernels);
+        
+        for (int v = 0; v < MAX_VOICES; ++v){
+            VoiceType& voice = voices[v];
+            if(envelopes[v] != nullptr){
+                if(perVoiceNoise){
+                    kernels->fillNoise(voice.noiseGen, noiseBlock, SampleType(partFor(voice.channel).noiseMix), runLength);
+                }
+                voice.template render<withNoise>(noiseBlock, envelopeFrames + v, MAX_VOICES, mixLeft, mixRight, runLength,
+                                                 SampleType(params.voicePowerFall));
+                voiceSamplesRendered[size_t(voice.channel)] += uint64_t(runLength);
+                endIfInaudible(voice);
             }
         }
         
-        float outputLevel = outputLevelSmoother.getNextValue();
-        outputLeft *= outputLevel;
-        outputRight *= outputLevel;
+        if(activeFades > 0){
+            renderFades(runLength);
+        }
+        
+        SampleType* left = outputBufferLeft + sample;
+        SampleType* right = isStereo ? outputBufferRight + sample : nullptr;
         
-        if(outputBufferRight != nullptr) {
-            outputBufferLeft[sample] = outputLeft;
-            outputBufferRight[sample] = outputRight;
+        if(!fixedFlags || outputLevelSmoother.isSmoothing()){
+            for(int i = 0; i < runLength; ++i){
+                SampleType outputLevel = outputLevelSmoother.getNextValue();
+                if(isStereo){
+                    left[i] = mixLeft[i] * outputLevel;
+                    right[i] = mixRight[i] * outputLevel;
+                }else{
+                    left[i] = (mixLeft[i] * outputLevel + mixRight[i] * outputLevel) * SampleType(0.5);
+                }
+            }
         }else{
-            outputBufferLeft[sample] = (outputLeft + outputRight) * 0.5;
+            const SampleType outputLevel = outputLevelSmoother.getTargetValue();
+            if(isStereo){
+                kernels->writeStereo(mixLeft, mixRight, left, right, outputLevel, runLength);
+            }else{
+                kernels->writeMono(mixLeft, mixRight, left, outputLevel, runLength);
+            }
         }
+        
+        sample += runLength;
     }
     
-    for (int v = 0; v < MAX_VOICES; ++v){
-        Voice& voice = voices[v];
-        if(!voice.env.isActive()){
-            voice.env.reset();
-            voice.filter.reset();
+    // Events at or past the end of the block still count.
+    if(eventIndex < numEvents){
+        resetFinishedVoices();
+        while(eventIndex < numEvents){
+            handleEvent(events[eventIndex++]);
         }
     }
-    
-    protectYourEars(outputBufferLeft, sampleCount);
-    protectYourEars(outputBufferRight, sampleCount);
 }
 
-void Synth::midiMessage(uint8_t data0, uint8_t data1, uint8_t data2)
+template <typename SampleType>
+void Synth<SampleType>::midiMessage(uint8_t data0, uint8_t data1, uint8_t data2)
+{
+    SynthEvent event;
+    if(decodeMidiEvent(0, data0, data1, data2, event)){
+        handleEvent(event);
+    }
+}
+
+template <typename SampleType>
+void Synth<SampleType>::handleEvent(const SynthEvent& event)
 {
-    switch(data0 & 0xF0){
-    // Note off
-    case 0x80:
-        noteOff(data1 & 0x7F);
+    const int channel = event.channel;
+    
+    switch(event.type){
+    case SynthEvent::Type::noteOff:
+        noteOff(event.number, channel);
         break;
         
-    // Note on
-    case 0x90: {
-        uint8_t note = data1 & 0x7F;
-        uint8_t velo = data2 & 0x7F;
-        if(velo > 0){
-            noteOn(note,velo);
-        }else{
-            noteOff(note);
-        }
+    case SynthEvent::Type::noteOn:
+        noteOn(event.number, event.value, channel);
         break;
-    }
     
-    // Channel aftertouch
-    case 0xD0:
-        pressure = 0.0001f * float(data1 * data1);
+    case SynthEvent::Type::pressure:
+        if(isMemberChannel(channel)){
+            channelPressure[channel] = SampleType(0.0001) * SampleType(event.value * event.value);
+            for(int v = 0; v < MAX_VOICES; ++v){
+                if(voices[v].channel == channel){ voices[v].notePressure = channelPressure[channel]; }
+            }
+        }else{
+            pressure = SampleType(0.0001) * SampleType(event.value * event.value);
+        }
         break;
             
-    // Pitch bend
-    case 0xE0:
-        pitchBend = std::exp(-0.000014102f * float(data1 + 128 * data2 - 8192));
+    case SynthEvent::Type::pitchBend:
+        if(isMemberChannel(channel)){
+            // The default bend is +/-2 semitones; member channels use the
+            // much wider MPE range, parts the default.
+            SampleType range = params.multiTimbral ? SampleType(1) : SampleType(params.mpeBendRange) / SampleType(2);
+            channelPitchBend[channel] = std::exp(SampleType(-0.000014102) * range * SampleType(int(event.value) - 8192));
+            for(int v = 0; v < MAX_VOICES; ++v){
+                if(voices[v].channel == channel){ voices[v].notePitchBend = channelPitchBend[channel]; }
+            }
+        }else{
+            pitchBend = std::exp(SampleType(-0.000014102) * SampleType(int(event.value) - 8192));
+        }
         break;
     
-    // Control change
-    case 0xB0: {
-        controlChange(data1, data2);
-        break;
-    }
-    case 0x01:
-        modWheel = 0.000005f * float(data2 * data2);
+    case SynthEvent::Type::controlChange:
+        // Each part has its own sustain pedal.
+        if(event.number == 0x40 && params.multiTimbral){
+            channelSustain[channel] = event.value >= 64;
+            if(!channelSustain[channel]){
+                noteOff(SUSTAIN, channel);
+            }
+            break;
+        }
+        // CC 74 is the MPE "slide" dimension, which opens the filter.
+        if(event.number == 0x4A && params.mpe && isMemberChannel(channel)){
+            channelSlide[channel] = SampleType(0.02) * SampleType(int(event.value) - 64);
+            for(int v = 0; v < MAX_VOICES; ++v){
+                if(voices[v].channel == channel){ voices[v].noteSlide = channelSlide[channel]; }
+            }
+            break;
+        }
+        controlChange(event.number, uint8_t(event.value));
         break;
     }
 }
 
-void Synth::noteOn(int note, int velocity)
+template <typename SampleType>
+void Synth<SampleType>::noteOn(int note, int velocity, int channel)
 {
-    if(ignoreVelocity){ velocity = 80; }
+    const SynthParams& part = partFor(channel);
+    
+    // Not mapped by the current tuning.
+    if(part.notePeriod[note] <= 0.0f){ return; }
+    
+    if(part.ignoreVelocity){ velocity = 80; }
     
     int v = 0;  // index of the voice to use (0 = mono voice)
     
-    if(numVoices == 1){
+    if(params.numVoices == 1){
         if(voices[0].note > 0){
             shiftQueuedNotes();
+            voices[0].channel = channel;
             restartMonoVoice(note, velocity);
+            applyChannelExpression(voices[0], channel);
             return;
         }
     }
@@ -185,70 +492,82 @@ void Synth::noteOn(int note, int velocity)
         v = findFreeVoice();
     }
     
-    startVoice(v, note, velocity);
+    startVoice(v, note, velocity, channel);
+    applyChannelExpression(voices[v], channel);
 }
 
-void Synth::startVoice(int v, int note, int velocity)
+template <typename SampleType>
+void Synth<SampleType>::startVoice(int v, int note, int velocity, int channel)
 {
-    float period = calcPeriod(v, note);
+    if(params.numVoices > 1 && voices[v].env.isActive()){
+        fadeOutStolenVoice(v);
+    }
     
-    Voice& voice = voices[v];
+    const SynthParams& part = partFor(channel);
+    SampleType period = calcPeriod(v, note, part);
+    
+    VoiceType& voice = voices[v];
+    voice.channel = channel;
     voice.target = period;
     
-    voice.cutoff = sampleRate / (period * PI);
-    voice.cutoff *= std::exp(velocitySensitivity * float(velocity - 64));
+    voice.logCutoff = std::log(sampleRate / (period * PI)) + SampleType(part.velocitySensitivity) * SampleType(velocity - 64);
     
     int noteDistance = 0;
     if(lastNote > 0){
-        if((glideMode == 2) || ((glideMode == 1) && isPlayingLegatoStyle())){
+        if((part.glideMode == 2) || ((part.glideMode == 1) && isPlayingLegatoStyle())){
             noteDistance = note - lastNote;
         }
     }
     
-    voice.period = period * std::pow(1.059463094359f, float(noteDistance) - glideBend);
+    voice.period = period * std::pow(SampleType(1.059463094359), SampleType(noteDistance) - SampleType(part.glideBend));
     
-    if(voice.period < 6.0f) { voice.period = 6.0f; }
+    if(voice.period < 6) { voice.period = 6; }
     
     lastNote = note;
     voice.note = note;
     voice.updatePanning();
+    voice.signalPower = 0;
     
-    float vel = 0.004f * float((velocity + 64) * (velocity + 64)) - 8.0f;
+    SampleType vel = SampleType(0.004) * SampleType((velocity + 64) * (velocity + 64)) - SampleType(8);
     
-    voice.osc1.amplitude = volumeTrim * vel;
-    voice.osc2.amplitude = voice.osc1.amplitude * oscMix;
+    voice.osc1.amplitude = part.volumeTrim * vel;
+    voice.osc2.amplitude = voice.osc1.amplitude * part.oscMix;
     
-    if(vibrato == 0.0f && pwmDepth > 0.0f) {
+    if(part.vibrato == 0.0f && part.pwmDepth > 0.0f) {
         voice.osc2.squareWave(voice.osc1, voice.period);
     }
     
-    Envelope& env = voice.env;
-    env.attackMultiplier = envAttack;
-    env.decayMultiplier = envDecay;
-    env.sustainLevel = envSustain;
-    env.releaseMultiplier = envRelease;
+    auto& env = voice.env;
+    env.attackMultiplier = part.envAttack;
+    env.decayMultiplier = part.envDecay;
+    env.sustainLevel = part.envSustain;
+    env.releaseMultiplier = part.envRelease;
     env.attack();
     
-    Envelope& filterEnv = voice.filterEnv;
-    filterEnv.attackMultiplier = filterAttack;
-    filterEnv.decayMultiplier = filterDecay;
-    filterEnv.sustainLevel = filterSustain;
-    filterEnv.releaseMultiplier = filterRelease;
+    auto& filterEnv = voice.filterEnv;
+    filterEnv.attackMultiplier = part.filterAttack;
+    filterEnv.decayMultiplier = part.filterDecay;
+    filterEnv.sustainLevel = part.filterSustain;
+    filterEnv.releaseMultiplier = part.filterRelease;
     filterEnv.attack();
 }
 
-void Synth::noteOff(int note)
+template <typename SampleType>
+void Synth<SampleType>::noteOff(int note, int channel)
 {
-    if((numVoices == 1) && (voices[0].note == note)){
+    if((params.numVoices == 1) && (voices[0].note == note)){
         int queuedNote = nextQueuedNote();
         if(queuedNote > 0){
             restartMonoVoice(queuedNote, -1);
         }
     }
     
+    // With MPE the same note number can sound on several channels at once.
+    bool anyChannel = (channel < 0) || !isMemberChannel(channel);
+    
     for(int v = 0; v < MAX_VOICES; v++){
-        if(voices[v].note == note){
-            if(sustainPedalPressed){
+        if(voices[v].note == note && (anyChannel || voices[v].channel == channel)){
+            if(isSustained(channel)){
                 voices[v].note = SUSTAIN;
             }else{
                 voices[v].release();
@@ -258,19 +577,21 @@ void Synth::noteOff(int note)
     }
 }
 
-float Synth::calcPeriod(int v, int note) const
+template <typename SampleType>
+SampleType Synth<SampleType>::calcPeriod(int v, int note, const SynthParams& part) const
 {
-    float period = tune * std::exp(-0.05776226505f * (float(note) + ANALOG * float(v)));
+    SampleType period = SampleType(part.notePeriod[note]) * analogDetune[v];
     
-    while(period < 6.0f || (period * detune) < 6.0f){ period += period; };
+    while(period < 6 || (period * SampleType(part.detune)) < 6){ period += period; };
     
     return period;
 }
 
-int Synth::findFreeVoice() const
+template <typename SampleType>
+int Synth<SampleType>::findFreeVoice() const
 {
     int v = 0;
-    float l = 100.0f; // louder than any envelope!
+    SampleType l = 100; // louder than any envelope!
     
     for(int i = 0; i < MAX_VOICES; ++i){
         if(voices[i].env.level < l && !voices[i].env.isInAttack()){
@@ -281,7 +602,8 @@ int Synth::findFreeVoice() const
     return v;
 }
 
-void Synth::controlChange(uint8_t data1, uint8_t data2)
+template <typename SampleType>
+void Synth<SampleType>::controlChange(uint8_t data1, uint8_t data2)
 {
     switch(data1){
     
@@ -299,11 +621,11 @@ void Synth::controlChange(uint8_t data1, uint8_t data2)
 //            break;
         // Filter +
         case 0x4A:
-            filterCtl = 0.02f * float(data2);
+            filterCtl = SampleType(0.02) * SampleType(data2);
             break;
         // Filter -
         case 0x4B:
-            filterCtl = -0.03f * float(data2);
+            filterCtl = SampleType(-0.03) * SampleType(data2);
             break;
         default:
             if(data1 >= 0x78){
@@ -311,35 +633,39 @@ void Synth::controlChange(uint8_t data1, uint8_t data2)
                     voices[v].reset();
                 }
                 sustainPedalPressed = false;
+                channelSustain.fill(false);
             }
     }
     
     // Resonance
     if(data1 == resoCC){
-        resonanceCtl = 154.0f / float(154 - data2);
+        resonanceCtl = SampleType(154) / SampleType(154 - data2);
     }
 }
 
-void Synth::restartMonoVoice(int note, int velocity)
+template <typename SampleType>
+void Synth<SampleType>::restartMonoVoice(int note, int velocity)
 {
-    float period = calcPeriod(0, note);
+    VoiceType& voice = voices[0];
+    const SynthParams& part = partFor(voice.channel);
     
-    Voice& voice = voices[0];
+    SampleType period = calcPeriod(0, note, part);
     voice.period = period;
     
-    if(glideMode == 0) { voice.period = period; }
+    if(part.glideMode == 0) { voice.period = period; }
     
-    voice.env.level += SILENCE + SILENCE;
+    voice.env.level += SampleType(SILENCE + SILENCE);
     voice.note = note;
     voice.updatePanning();
     
-    voice.cutoff = sampleRate / (period * PI);
+    voice.logCutoff = std::log(sampleRate / (period * PI));
     if(velocity > 0){
-        voice.cutoff *= std::exp(velocitySensitivity * float(velocity - 64));
+        voice.logCutoff += SampleType(part.velocitySensitivity) * SampleType(velocity - 64);
     }
 }
 
-void Synth::shiftQueuedNotes()
+template <typename SampleType>
+void Synth<SampleType>::shiftQueuedNotes()
 {
     for(int tmp = MAX_VOICES - 1; tmp > 0; tmp--){
         voices[tmp].note = voices[tmp - 1].note;
@@ -347,7 +673,8 @@ void Synth::shiftQueuedNotes()
     }
 }
 
-int Synth::nextQueuedNote()
+template <typename SampleType>
+int Synth<SampleType>::nextQueuedNote()
 {
     int held = 0;
     for(int v = MAX_VOICES - 1; v > 0; v--)
@@ -365,29 +692,35 @@ int Synth::nextQueuedNote()
     return 0;
 }
 
-void Synth::updateLFO()
+template <typename SampleType>
+void Synth<SampleType>::updateLFO()
 {
     if(--lfoStep <= 0){
-        lfoStep = LFO_MAX;
+        lfoStep = params.controlPeriod;
         
-        lfo += lfoInc;
+        lfo += params.lfoInc;
         if(lfo > PI) { lfo -= TWO_PI; }
         
-        const float sine = std::sin(lfo);
+        const SampleType sine = std::sin(lfo);
         
-        float vibratoMod = 1.0f + sine * (modWheel + vibrato);
-        float pwm = 1.0f + sine * (modWheel + pwmDepth);
+        if(params.multiTimbral){
+            updatePartLFOs();
+            return;
+        }
+        
+        SampleType vibratoMod = SampleType(1) + sine * (modWheel + SampleType(params.vibrato));
+        SampleType pwm = SampleType(1) + sine * (modWheel + SampleType(params.pwmDepth));
         
-        float filterMod = filterKeyTracking + filterCtl + (filterLFODepth + pressure) * sine;
+        SampleType filterMod = SampleType(params.filterKeyTracking) + filterCtl + (SampleType(params.filterLFODepth) + pressure) * sine;
         
-        filterZip += 0.005f * (filterMod - filterZip);
+        filterZip += SampleType(params.filterZipCoeff) * (filterMod - filterZip);
         
         for (int v = 0; v < MAX_VOICES; ++v){
-            Voice& voice = voices[v];
+            VoiceType& voice = voices[v];
             if(voice.env.isActive()){
                 voice.osc1.modulation = vibratoMod;
                 voice.osc2.modulation = pwm;
-                voice.filterMod = filterZip;
+                voice.filterMod = filterZip + voice.noteSlide + voice.notePressure * sine;
                 voice.updateLFO();
                 updatePeriod(voice);
             }
@@ -395,7 +728,39 @@ void Synth::updateLFO()
     }
 }
 
-bool Synth::isPlayingLegatoStyle() const
+template <typename SampleType>
+void Synth<SampleType>::updatePartLFOs()
+{
+    // Same as the single-part LFO, but every part runs at its own rate and
+    // depths. The mod wheel, filter controllers and resonance stay global.
+    std::array<SampleType, NUM_CHANNELS> sines;
+    for(int ch = 0; ch < NUM_CHANNELS; ++ch){
+        const SynthParams& part = parts[size_t(ch)];
+        
+        partLfo[ch] += part.lfoInc;
+        if(partLfo[ch] > PI) { partLfo[ch] -= TWO_PI; }
+        sines[ch] = std::sin(partLfo[ch]);
+        
+        SampleType filterMod = SampleType(part.filterKeyTracking) + filterCtl + SampleType(part.filterLFODepth) * sines[ch];
+        partFilterZip[ch] += SampleType(part.filterZipCoeff) * (filterMod - partFilterZip[ch]);
+    }
+    
+    for (int v = 0; v < MAX_VOICES; ++v){
+        VoiceType& voice = voices[v];
+        if(voice.env.isActive()){
+            const SynthParams& part = parts[size_t(voice.channel)];
+            const SampleType sine = sines[voice.channel];
+            voice.osc1.modulation = SampleType(1) + sine * (modWheel + SampleType(part.vibrato));
+            voice.osc2.modulation = SampleType(1) + sine * (modWheel + SampleType(part.pwmDepth));
+            voice.filterMod = partFilterZip[voice.channel] + voice.notePressure * sine;
+            voice.updateLFO();
+            updatePeriod(voice);
+        }
+    }
+}
+
+template <typename SampleType>
+bool Synth<SampleType>::isPlayingLegatoStyle() const
 {
     int held = 0;
     for(int i = 0; i < MAX_VOICES; ++i){
@@ -403,3 +768,40 @@ bool Synth::isPlayingLegatoStyle() const
     }
     return held > 0;
 }
+
+template <typename SampleType>
+bool Synth<SampleType>::isMemberChannel(int channel) const
+{
+    // MPE lower zone: channel 1 is the master channel, 2-16 carry one note
+    // each. In multi-timbral mode every channel is a part of its own.
+    return (params.mpe && channel > 0) || (params.multiTimbral && channel >= 0);
+}
+
+template <typename SampleType>
+bool Synth<SampleType>::isSustained(int channel) const
+{
+    if(params.multiTimbral){
+        return channel >= 0 && channelSustain[size_t(channel)];
+    }
+    return sustainPedalPressed;
+}
+
+template <typename SampleType>
+void Synth<SampleType>::applyChannelExpression(VoiceType& voice, int channel)
+{
+    voice.channel = channel;
+    if(isMemberChannel(channel)){
+        voice.notePitchBend = channelPitchBend[channel];
+        voice.notePressure = channelPressure[channel];
+        voice.noteSlide = channelSlide[channel];
+    }else{
+        voice.notePitchBend = 1.0f;
+        voice.notePressure = 0.0f;
+        voice.noteSlide = 0.0f;
+    }
+    voice.setPitchBend(pitchBend * voice.notePitchBend);
+    updatePeriod(voice);
+}
+
+template class Synth<float>;
+template class Synth<double>;
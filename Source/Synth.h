@@ -13,7 +13,19 @@
 #include <JuceHeader.h>
 #include "Voice.h"
 #include "NoiseGenerator.h"
+#include "Limiter.h"
+#include "Ensemble.h"
+#include "FdnReverb.h"
+#include "Utils.h"
+#include "SynthParams.h"
+#include "DspKernels.h"
+#include "MidiEventQueue.h"
+#include "CutoffTable.h"
 
+// The engine is templated on the sample type so double-precision hosts and
+// reference renders can run it natively. Synth.cpp instantiates it for
+// float and double.
+template <typename SampleType>
 class Synth
 {
 public:
@@ -21,71 +33,141 @@ public:
     void allocateResources(double sampleRate, int samplesPerBlock);
     void deallocateResources();
     void reset();
-    void render(float** outputBuffers, int sampleCount);
+    // Renders the whole block in one pass, applying the events (sorted by
+    // offset) at their exact sample positions. Denormals are flushed to zero
+    // for the duration of the call, whichever thread makes it.
+    void render(SampleType** outputBuffers, int sampleCount, const SynthEvent* events = nullptr, int numEvents = 0);
     void midiMessage(uint8_t data0, uint8_t data1, uint8_t data2);
-    float noiseMix;
-    float envAttack;
-    float envDecay;
-    float envSustain;
-    float envRelease;
-    float oscMix;
-    float detune;
-    float tune;
+    void handleEvent(const SynthEvent& event);
+    void setParams(const SynthParams& newParams);
+    void setPartParams(const PartParams& newParts);
     static constexpr int MAX_VOICES = 8;
-    int numVoices;
-    float volumeTrim;
-    juce::LinearSmoothedValue<float> outputLevelSmoother;
-    float velocitySensitivity;
-    bool ignoreVelocity;
-    const int LFO_MAX = 32;
-    float lfoInc;
-    float vibrato;
-    float pwmDepth;
-    int glideMode;
-    float glideRate;
-    float glideBend;
-    float filterKeyTracking;
-    float filterQ;
-    float filterLFODepth;
-    float filterAttack;
-    float filterDecay;
-    float filterSustain;
-    float filterRelease;
-    float filterEnvDepth;
+    static_assert(MAX_VOICES == ENVELOPE_LANES, "the envelopes are rendered one voice per lane");
+    static constexpr int NUM_CHANNELS = 16;
+    static constexpr int MAX_CONTROL_PERIOD = 64;
+    
+    // How far the output lags behind: the limiter's lookahead, which is
+    // there whether the limiter is on or not.
+    static constexpr int LATENCY_SAMPLES = TruePeakLimiter<SampleType>::LOOKAHEAD;
+    
+    SynthParams params;
+    juce::LinearSmoothedValue<SampleType> outputLevelSmoother;
     uint8_t resoCC = 0x47;
+    OutputGuardStats outputStats;
+    
+    // Voice-samples rendered, and the ones skipped by ending fading voices
+    // before their envelopes reached SILENCE, per MIDI channel of the note.
+    // Only the audio thread touches these; the owner reads and clears them
+    // between render calls.
+    std::array<uint64_t, NUM_CHANNELS> voiceSamplesRendered {};
+    std::array<uint64_t, NUM_CHANNELS> voiceSamplesSaved {};
+    
+    // render() sets FTZ/DAZ for its duration. Only benchmarks turn this off,
+    // to measure what the explicit flushing alone achieves.
+    bool flushDenormals = true;
+    
+    // Off, every block goes through one loop that tests the output and noise
+    // settings as it renders, instead of the kernel compiled for them. Only
+    // the render benchmark turns this off, as its baseline.
+    bool specializeRender = true;
     
     
 private:
-    void noteOn(int note, int velocity);
-    void noteOff(int note);
-    float calcPeriod(int v, int note) const;
-    void startVoice(int v, int note, int velocity);
+    using VoiceType = Voice<SampleType>;
+    
+    // How the noise source is mixed in. Constant for a whole block.
+    enum class NoiseMode { none, shared, perVoice };
+    
+    template <bool stereo, NoiseMode noiseMode, bool fixedFlags>
+    void renderRuns(SampleType* outputBufferLeft, SampleType* outputBufferRight, int sampleCount,
+                    const SynthEvent* events, int numEvents);
+    
+    void updateVoiceControls();
+    void resetFinishedVoices();
+    void endIfInaudible(VoiceType& voice);
+    void fadeOutStolenVoice(int v);
+    void renderFades(int sampleCount);
+    
+    void noteOn(int note, int velocity, int channel);
+    void noteOff(int note, int channel = -1);
+    SampleType calcPeriod(int v, int note, const SynthParams& part) const;
+    void startVoice(int v, int note, int velocity, int channel);
     int findFreeVoice() const;
     void controlChange(uint8_t data1, uint8_t data2);
     void restartMonoVoice(int note, int velocity);
     void shiftQueuedNotes();
     int nextQueuedNote();
     void updateLFO();
+    void updatePartLFOs();
     bool isPlayingLegatoStyle() const;
+    bool isMemberChannel(int channel) const;
+    bool isSustained(int channel) const;
+    void applyChannelExpression(VoiceType& voice, int channel);
     
     float sampleRate;
     //Voice voice;
     NoiseGenerator noiseGen;
-    float pitchBend;
+    SampleType pitchBend;
     bool sustainPedalPressed;
-    std::array<Voice, MAX_VOICES> voices;
+    std::array<VoiceType, MAX_VOICES> voices;
     int lfoStep;
-    float lfo;
-    float modWheel;
+    SampleType lfo;
+    SampleType modWheel;
     int lastNote;
-    float resonanceCtl;
-    float pressure;
-    float filterCtl;
-    float filterZip;
+    SampleType resonanceCtl;
+    SampleType pressure;
+    SampleType filterCtl;
+    SampleType filterZip;
+    std::array<SampleType, MAX_VOICES> analogDetune;
+    CutoffTable<SampleType> cutoffTable;
+    Ensemble<SampleType> ensemble;
+    FdnReverb<SampleType> reverb;
+    TruePeakLimiter<SampleType> limiter;
+    const DspKernels<SampleType>* kernels;
+    SampleType voiceEndPower;
+    
+    // When a sounding voice is stolen, the value it last added to the mix
+    // ramps down to zero here while the voice starts the new note from
+    // silence. One slot per voice; a second steal adds to the first.
+    struct Fade
+    {
+        SampleType left, right;
+        SampleType stepLeft, stepRight;
+        int remaining;
+    };
+    std::array<Fade, MAX_VOICES> fades;
+    int fadeLength;
+    int activeFades;
+    
+    // MPE expression per MIDI channel, kept so a note picks up the bend,
+    // pressure and slide that were sent on its channel before the note-on.
+    std::array<SampleType, NUM_CHANNELS> channelPitchBend;
+    std::array<SampleType, NUM_CHANNELS> channelPressure;
+    std::array<SampleType, NUM_CHANNELS> channelSlide;
+    
+    // Multi-timbral mode: the settings, LFO phase, filter modulation and
+    // sustain pedal of every part.
+    PartParams parts;
+    std::array<SampleType, NUM_CHANNELS> partLfo;
+    std::array<SampleType, NUM_CHANNELS> partFilterZip;
+    std::array<bool, NUM_CHANNELS> channelSustain;
+    bool partsUseNoise = false;
+    
+    // The settings a voice on this channel plays with.
+    const SynthParams& partFor(int channel) const
+    {
+        return params.multiTimbral ? parts[size_t(channel)] : params;
+    }
+    
+    // Scratch buffers for one control-rate run.
+    SampleType noiseBlock[MAX_CONTROL_PERIOD];
+    SampleType envelopeFrames[MAX_CONTROL_PERIOD * MAX_VOICES];   // voice v at [n * MAX_VOICES + v]
+    SampleType mixLeft[MAX_CONTROL_PERIOD];
+    SampleType mixRight[MAX_CONTROL_PERIOD];
     
-    inline void updatePeriod(Voice& voice)
+    inline void updatePeriod(VoiceType& voice)
     {
-        voice.osc1.period = voice.period * pitchBend;
-        voice.osc2.period = voice.osc1.period * detune;
+        voice.osc1.period = voice.period * voice.pitchBend;
+        voice.osc2.period = voice.osc1.period * SampleType(partFor(voice.channel).detune);
     }
 };
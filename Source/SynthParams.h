@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    SynthParams.h
+    Created: 19 Oct 2026 11:02:15am
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// Everything the engine needs from the plug-in parameters, already converted
+// to engine units. Built off the audio thread, so the exp/pow work of the
+// parameter mapping never runs while rendering.
+struct SynthParams
+{
+    int numVoices = 8;
+    int glideMode = 0;
+    float glideRate = 1.0f;
+    float glideBend = 0.0f;
+
+    float oscMix = 0.0f;
+    float detune = 1.0f;
+    float tune = 1.0f;
+    float volumeTrim = 0.0f;
+    float noiseMix = 0.0f;
+    float outputLevel = 1.0f;
+    
+    // A fading voice is ended once its output is below this level (linear,
+    // 0 = only when the envelope is silent). voicePowerFall is how much of
+    // the measured level is kept per control period.
+    float voiceFloor = 0.0f;
+    float voicePowerFall = 0.98f;
+
+    float velocitySensitivity = 0.0f;
+    bool ignoreVelocity = false;
+
+    float envAttack = 0.0f;
+    float envDecay = 0.0f;
+    float envSustain = 0.0f;
+    float envRelease = 0.0f;
+
+    float filterKeyTracking = 0.0f;
+    float filterQ = 1.0f;
+    float filterLFODepth = 0.0f;
+    float filterAttack = 0.0f;
+    float filterDecay = 0.0f;
+    float filterSustain = 0.0f;
+    float filterRelease = 0.0f;
+    float filterEnvDepth = 0.0f;
+
+    int controlPeriod = 32;
+    float filterZipCoeff = 0.005f;
+    float lfoInc = 0.0f;
+    float vibrato = 0.0f;
+    float pwmDepth = 0.0f;
+
+    // Oscillator period in samples for every MIDI note, built from the tune
+    // setting and the loaded tuning. Zero for notes the tuning leaves out.
+    std::array<float, 128> notePeriod {};
+    
+    bool mpe = false;
+    float mpeBendRange = 48.0f;   // semitones, the MPE default for member channels
+    
+    // Every MIDI channel plays with its own snapshot from PartParams. The
+    // voice pool, polyphony, output level, quality and effects still come
+    // from this one. Can't be combined with MPE.
+    bool multiTimbral = false;
+    
+    int ensembleMode = 0;   // 0 = off
+    float reverbMix = 0.0f;   // 0 = off
+    float reverbDecay = 2.0f;   // seconds to -60 dB
+    bool softLimiter = false;
+    bool perVoiceNoise = false;
+};
+
+// The settings for each MIDI channel in multi-timbral mode.
+using PartParams = std::array<SynthParams, 16>;
+
+// Hands the newest snapshot from a writer to the audio thread without locks.
+// There are three slots: the writer fills its own slot and swaps it into the
+// middle with a single atomic exchange; the reader swaps the middle slot with
+// the one it owns only when a new snapshot is waiting. Neither side ever
+// touches a slot the other one is using. Only one thread may write at a time.
+template <typename T>
+class SnapshotExchange
+{
+public:
+    T& beginWrite()
+    {
+        return slots[writeIndex];
+    }
+
+    void publish()
+    {
+        int previous = middle.exchange(writeIndex | NEW_DATA, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // Returns the newest snapshot, or nullptr if nothing changed since the
+    // last call. The pointer stays valid until the next successful acquire().
+    const T* acquire()
+    {
+        if((middle.load(std::memory_order_relaxed) & NEW_DATA) == 0){
+            return nullptr;
+        }
+        int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return &slots[readIndex];
+    }
+
+private:
+    static constexpr int INDEX_MASK = 3;
+    static constexpr int NEW_DATA = 4;
+
+    T slots[3];
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middle { 2 };
+};
@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+    Tuning.h
+    Created: 19 Oct 2026 1:48:27pm
+    Author:  Edmund í Garði
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// A Scala scale (.scl) plus keyboard mapping (.kbm), compiled into the pitch
+// of every MIDI note in equal-tempered semitones, so 69.0 is A4 at 440 Hz.
+// Everything is done when the files are loaded; the synth only ever looks up
+// a finished table. Keys the mapping leaves out are NaN.
+class Tuning
+{
+public:
+    static constexpr int NUM_NOTES = 128;
+
+    Tuning()
+    {
+        reset();
+    }
+
+    // Back to 12-TET.
+    void reset()
+    {
+        sclText.clear();
+        kbmText.clear();
+        for(int n = 0; n < NUM_NOTES; ++n){
+            semitones[size_t(n)] = float(n);
+        }
+    }
+
+    // Either text may be empty: no scale means 12-TET, no mapping means the
+    // Scala default (linear, degree 0 on middle C at 261.6256 Hz). Returns
+    // false and leaves the tuning alone if either file can't be parsed.
+    bool load(const std::string& scl, const std::string& kbm)
+    {
+        std::vector<double> cents;
+        if(scl.empty()){
+            for(int i = 1; i <= 12; ++i){ cents.push_back(100.0 * i); }
+        }else if(!parseScale(scl, cents)){
+            return false;
+        }
+
+        Mapping mapping;
+        if(!kbm.empty() && !parseMapping(kbm, mapping)){
+            return false;
+        }
+        if(mapping.octaveDegree == 0){
+            mapping.octaveDegree = int(cents.size());
+        }
+
+        const double referenceCents = degreeToCents(cents, keyToDegree(mapping, mapping.referenceNote, true));
+        const double referenceSemitones = 69.0 + 12.0 * std::log2(mapping.referenceFrequency / 440.0);
+
+        for(int n = 0; n < NUM_NOTES; ++n){
+            float value = std::numeric_limits<float>::quiet_NaN();
+            if(n >= mapping.firstNote && n <= mapping.lastNote){
+                int degree = keyToDegree(mapping, n, false);
+                if(degree != UNMAPPED){
+                    value = float(referenceSemitones + (degreeToCents(cents, degree) - referenceCents) / 100.0);
+                }
+            }
+            semitones[size_t(n)] = value;
+        }
+
+        sclText = scl;
+        kbmText = kbm;
+        return true;
+    }
+
+    // Pitch of a MIDI note in 12-TET semitones, or NaN if it is unmapped.
+    float getSemitones(int note) const
+    {
+        return semitones[size_t(note)];
+    }
+
+    // The files this tuning was loaded from, for saving with the plug-in state.
+    const std::string& getScaleText() const { return sclText; }
+    const std::string& getMappingText() const { return kbmText; }
+
+private:
+    static constexpr int UNMAPPED = std::numeric_limits<int>::min();
+
+    struct Mapping
+    {
+        int firstNote = 0;
+        int lastNote = NUM_NOTES - 1;
+        int middleNote = 60;
+        int referenceNote = 60;
+        double referenceFrequency = 261.6255653;
+        int octaveDegree = 0;
+        std::vector<int> keys;   // empty means linear
+    };
+
+    static int floorDiv(int a, int b)
+    {
+        return (a >= 0) ? a / b : -((-a + b - 1) / b);
+    }
+
+    static int keyToDegree(const Mapping& mapping, int note, bool fallbackToLinear)
+    {
+        int offset = note - mapping.middleNote;
+        if(mapping.keys.empty()){
+            return offset;
+        }
+
+        int size = int(mapping.keys.size());
+        int octave = floorDiv(offset, size);
+        int degree = mapping.keys[size_t(offset - octave * size)];
+        if(degree == UNMAPPED){
+            return fallbackToLinear ? offset : UNMAPPED;
+        }
+        return degree + octave * mapping.octaveDegree;
+    }
+
+    static double degreeToCents(const std::vector<double>& cents, int degree)
+    {
+        int size = int(cents.size());
+        int octave = floorDiv(degree, size);
+        int step = degree - octave * size;
+        return octave * cents.back() + ((step == 0) ? 0.0 : cents[size_t(step - 1)]);
+    }
+
+    // Non-comment lines with surrounding whitespace removed.
+    static std::vector<std::string> dataLines(const std::string& text)
+    {
+        std::vector<std::string> lines;
+        std::istringstream stream(text);
+        std::string line;
+        while(std::getline(stream, line)){
+            size_t begin = line.find_first_not_of(" \t\r");
+            size_t end = line.find_last_not_of(" \t\r");
+            line = (begin == std::string::npos) ? std::string() : line.substr(begin, end - begin + 1);
+            if(!line.empty() && line[0] == '!'){ continue; }
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    static bool parseScale(const std::string& text, std::vector<double>& cents)
+    {
+        // Line 0 is the description, which may be empty.
+        std::vector<std::string> lines = dataLines(text);
+        if(lines.size() < 2){ return false; }
+
+        int count = std::atoi(lines[1].c_str());
+        if(count < 1 || lines.size() < size_t(count) + 2){ return false; }
+
+        for(int i = 0; i < count; ++i){
+            std::istringstream stream(lines[size_t(i) + 2]);
+            std::string token;
+            stream >> token;
+
+            double value;
+            if(token.find('.') != std::string::npos){
+                value = std::atof(token.c_str());
+            }else{
+                size_t slash = token.find('/');
+                double numerator = std::atof(token.substr(0, slash).c_str());
+                double denominator = (slash == std::string::npos) ? 1.0 : std::atof(token.substr(slash + 1).c_str());
+                if(numerator <= 0.0 || denominator <= 0.0){ return false; }
+                value = 1200.0 * std::log2(numerator / denominator);
+            }
+            cents.push_back(value);
+        }
+
+        return cents.back() > 0.0;
+    }
+
+    static bool parseMapping(const std::string& text, Mapping& mapping)
+    {
+        std::vector<std::string> lines;
+        for(const auto& line : dataLines(text)){
+            if(!line.empty()){ lines.push_back(line); }
+        }
+        if(lines.size() < 7){ return false; }
+
+        int size = std::atoi(lines[0].c_str());
+        mapping.firstNote = std::max(0, std::atoi(lines[1].c_str()));
+        mapping.lastNote = std::min(NUM_NOTES - 1, std::atoi(lines[2].c_str()));
+        mapping.middleNote = std::atoi(lines[3].c_str());
+        mapping.referenceNote = std::atoi(lines[4].c_str());
+        mapping.referenceFrequency = std::atof(lines[5].c_str());
+        mapping.octaveDegree = std::atoi(lines[6].c_str());
+
+        if(size < 0 || mapping.referenceFrequency <= 0.0){ return false; }
+
+        for(int i = 0; i < size; ++i){
+            // Trailing entries may be left out, they count as unmapped.
+            size_t index = size_t(i) + 7;
+            bool mapped = index < lines.size() && lines[index][0] != 'x';
+            mapping.keys.push_back(mapped ? std::atoi(lines[index].c_str()) : UNMAPPED);
+        }
+        return true;
+    }
+
+    std::array<float, NUM_NOTES> semitones;
+    std::string sclText;
+    std::string kbmText;
+};
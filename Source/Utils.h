@@ -10,39 +10,79 @@
 
 #pragma once
 
-inline void protectYourEars(float* buffer, int sampleCount)
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Counts how often the output guard had to step in. Written on the audio
+// thread, read by whoever wants to show or log it.
+struct OutputGuardStats
+{
+    std::atomic<uint32_t> nonFinite { 0 };
+    std::atomic<uint32_t> screaming { 0 };
+    std::atomic<uint32_t> clamped { 0 };
+};
+
+inline void protectYourEars(float* buffer, int sampleCount, OutputGuardStats& stats)
 {
     if (buffer == nullptr) { return; }
-    bool firstWarning = true;
+    
+    // Find the largest magnitude by comparing the bit patterns as integers.
+    // For positive floats these sort in the same order as the values, and
+    // NaN / Inf sort above everything else. The loop has no branches, so the
+    // compiler turns it into a vector max reduction.
+    uint32_t maxBits = 0;
     for (int i = 0; i < sampleCount; ++i){
-        float x = buffer[i];
-        bool silence = false;
-        if(std::isnan(x)){
-            DBG("!!! WARNING: nan detected in audio buffer, silencing !!!");
-            silence = true;
-        }else if (std::isinf(x)){
-            DBG("!!! WARNING: inf detected in audio buffer, silencing !!!");
-            silence = true;
-        }else if (x < -2.0f || x > 2.0f){ // Screaming feedback
-            DBG("!!! WARNING: sample out of range, silencing !!!");
-            silence = true;
-        }else if (x < -1.0f){
-            if(firstWarning){
-                DBG("!!! WARNING: sample out of range, clamping !!!");
-                firstWarning = false;
-            }
-            buffer[i] = -1.0f;
-        }else if (x > 1.0f){
-            if(firstWarning){
-                DBG("!!! WARNING: sample out of range, clamping !!!");
-                firstWarning = false;
-            }
-            buffer[i] = 1.0f;
-        }
-        if(silence){
-            memset(buffer, 0, sampleCount * sizeof(float));
-            return;
-        }
+        uint32_t bits;
+        std::memcpy(&bits, buffer + i, sizeof(bits));
+        bits &= 0x7FFFFFFFu;
+        maxBits = (bits > maxBits) ? bits : maxBits;
+    }
+    
+    if (maxBits <= 0x3F800000u){          // |x| <= 1.0
+        return;
+    }
+    if (maxBits >= 0x7F800000u){          // nan or inf
+        stats.nonFinite.fetch_add(1, std::memory_order_relaxed);
+        std::memset(buffer, 0, sampleCount * sizeof(float));
+    }else if (maxBits > 0x40000000u){     // |x| > 2.0, screaming feedback
+        stats.screaming.fetch_add(1, std::memory_order_relaxed);
+        std::memset(buffer, 0, sampleCount * sizeof(float));
+    }else{
+        stats.clamped.fetch_add(1, std::memory_order_relaxed);
+        juce::FloatVectorOperations::clip(buffer, buffer, -1.0f, 1.0f, sampleCount);
+    }
+}
+
+// Same checks for the double-precision engine, which runs live when the
+// host processes in double precision, so it gets the same branch-free scan
+// on the 64-bit patterns.
+inline void protectYourEars(double* buffer, int sampleCount, OutputGuardStats& stats)
+{
+    if (buffer == nullptr) { return; }
+    
+    uint64_t maxBits = 0;
+    for (int i = 0; i < sampleCount; ++i){
+        uint64_t bits;
+        std::memcpy(&bits, buffer + i, sizeof(bits));
+        bits &= 0x7FFFFFFFFFFFFFFFull;
+        maxBits = (bits > maxBits) ? bits : maxBits;
+    }
+    
+    if (maxBits <= 0x3FF0000000000000ull){          // |x| <= 1.0
+        return;
+    }
+    if (maxBits >= 0x7FF0000000000000ull){          // nan or inf
+        stats.nonFinite.fetch_add(1, std::memory_order_relaxed);
+        std::memset(buffer, 0, sampleCount * sizeof(double));
+    }else if (maxBits > 0x4000000000000000ull){     // |x| > 2.0, screaming feedback
+        stats.screaming.fetch_add(1, std::memory_order_relaxed);
+        std::memset(buffer, 0, sampleCount * sizeof(double));
+    }else{
+        stats.clamped.fetch_add(1, std::memory_order_relaxed);
+        juce::FloatVectorOperations::clip(buffer, buffer, -1.0, 1.0, sampleCount);
     }
 }
 
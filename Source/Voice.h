@@ -14,52 +14,106 @@
 #include "Envelope.h"
 //#include "Filter.h"
 #include "FilterLadder.h"
+#include "NoiseGenerator.h"
 
+template <typename SampleType>
 struct Voice
 {
     int note;
-    Oscillator osc1;
-    Oscillator osc2;
-    float saw;
-    Envelope env;
-    float period;
-    float panLeft, panRight;
-    float target;
-    float glideRate;
+    Oscillator<SampleType> osc1;
+    Oscillator<SampleType> osc2;
+    SampleType saw;
+    Envelope<SampleType> env;
+    SampleType period;
+    SampleType panLeft, panRight;
+    SampleType target;
+    SampleType glideRate;
     //Filter filter;
-    FilterLadder filter;
-    float cutoff;
-    float filterMod;
-    float filterQ;
-    float pitchBend;
-    Envelope filterEnv;
-    float filterEnvDepth;
+    FilterLadder<SampleType> filter;
+    SampleType logCutoff;   // natural log of the cutoff in Hz, before modulation
+    SampleType filterMod;
+    SampleType filterQ;
+    SampleType pitchBend;
+    SampleType logPitchBend;
+    
+    // MPE: the MIDI channel that started this note, and the expression
+    // received on that channel. The bend is stored as a period multiplier
+    // and the slide as a log-cutoff offset, so no exp is needed per sample.
+    int channel;
+    SampleType notePitchBend;
+    SampleType notePressure;
+    SampleType noteSlide;
+    
+    Envelope<SampleType> filterEnv;
+    SampleType filterEnvDepth;
+    NoiseGenerator noiseGen;
+    
+    // Mean square of the output before the envelope, held with a slow fall
+    // so a run that lands on a zero crossing doesn't make it look silent.
+    SampleType signalPower;
+    
+    // What the voice added to the mix on its last sample.
+    SampleType lastLeft, lastRight;
     
     void reset()
     {
         note = 0;
-        saw = 0.0f;
+        saw = 0;
         osc1.reset();
         osc2.reset();
         env.reset();
-        panLeft = 0.707f;
-        panRight = 0.707f;
+        panLeft = SampleType(0.707);
+        panRight = SampleType(0.707);
         filter.reset();
         filterEnv.reset();
+        channel = 0;
+        pitchBend = 1;
+        logPitchBend = 0;
+        notePitchBend = 1;
+        notePressure = 0;
+        noteSlide = 0;
+        signalPower = 0;
+        lastLeft = 0;
+        lastRight = 0;
     }
     
-    float render(float input)
+    // input is only read when withNoise is set. The envelope values are
+    // rendered beforehand for all voices at once (Envelope::renderLanes), so
+    // they are envelopeStride apart.
+    template <bool withNoise>
+    void render(const SampleType* input, const SampleType* envelope, int envelopeStride,
+                SampleType* outputLeft, SampleType* outputRight, int sampleCount, SampleType powerFall)
     {
-        float sample1 = osc1.nextSample();
-        float sample2 = osc2.nextSample();
-        saw = saw * 0.997f + sample1 - sample2;
+        SampleType power = 0;
+        SampleType last = 0;
+        for(int i = 0; i < sampleCount; ++i){
+            SampleType sample1 = osc1.nextSample();
+            SampleType sample2 = osc2.nextSample();
+            saw = saw * SampleType(0.997) + sample1 - sample2;
+            
+            SampleType output = saw;
+            if constexpr (withNoise){
+                output += input[i];
+            }
+            
+            output = filter.render(output);
+            power += output * output;
+            
+            output *= envelope[i * envelopeStride];
+            outputLeft[i] += output * panLeft;
+            outputRight[i] += output * panRight;
+            last = output;
+        }
         
-        float output = saw + input;
+        lastLeft = last * panLeft;
+        lastRight = last * panRight;
         
-        output = filter.render(output);
+        // Whenever the oscillators stop feeding them, the saw and the filter
+        // only decay, and would end up denormal.
+        juce::dsp::util::snapToZero(saw);
+        filter.snapToZero();
         
-        float envelope = env.nextValue();
-        return output * envelope;
+        signalPower = std::max(power / SampleType(sampleCount), signalPower * powerFall);
     }
     
     void release()
@@ -70,17 +124,26 @@ struct Voice
     
     void updatePanning()
     {
-        float panning = std::clamp((note - 60.0f) / 24.0f, -1.0f, 1.0f);
-        panLeft = std::sin(PI_OVER_4 * (1.0f - panning));
-        panRight = std::sin(PI_OVER_4 * (1.0f + panning));
+        SampleType panning = std::clamp(SampleType(note - 60) / SampleType(24), SampleType(-1), SampleType(1));
+        panLeft = std::sin(SampleType(PI_OVER_4) * (SampleType(1) - panning));
+        panRight = std::sin(SampleType(PI_OVER_4) * (SampleType(1) + panning));
     }
     
     void updateLFO()
     {
         period += glideRate * (target - period);
-        float fenv = filterEnv.nextValue();
-        float modulatedCutoff = cutoff * std::exp(filterMod + filterEnvDepth * fenv) / pitchBend;
-        modulatedCutoff = std::clamp(modulatedCutoff, 30.0f, 20000.0f);
-        filter.updateCoefficients(modulatedCutoff, filterQ);
+        SampleType fenv = filterEnv.nextValue();
+        juce::dsp::util::snapToZero(filterEnv.level);
+        filter.updateCoefficients(logCutoff + filterMod + filterEnvDepth * fenv - logPitchBend, filterQ);
+    }
+    
+    // The bend only changes with MIDI input, so its log is worked out here
+    // rather than on every control tick.
+    void setPitchBend(SampleType newPitchBend)
+    {
+        if(newPitchBend != pitchBend){
+            pitchBend = newPitchBend;
+            logPitchBend = std::log(newPitchBend);
+        }
     }
 };